@@ -0,0 +1,43 @@
+#ifndef ARRAYVIEW_H_211217
+#define ARRAYVIEW_H_211217
+
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+
+namespace GPS
+{
+  /*  A read-only view of a contiguous array owned by someone else.
+   *  The view is invalidated by anything that reallocates or destroys the array.
+   */
+  template <typename T>
+  class ArrayView
+  {
+    public:
+      ArrayView() : first(nullptr), count(0) {}
+      ArrayView(const T * first, std::size_t count) : first(first), count(count) {}
+      ArrayView(const std::vector<T> & v) : first(v.data()), count(v.size()) {}
+
+      const T * begin() const { return first; }
+      const T * end() const { return first + count; }
+      const T * data() const { return first; }
+
+      std::size_t size() const { return count; }
+      bool empty() const { return count == 0; }
+
+      const T & operator[](std::size_t i) const { return first[i]; }
+
+      // Throws a std::out_of_range exception if out-of-range.
+      const T & at(std::size_t i) const
+      {
+          if (i >= count) throw std::out_of_range("ArrayView index out of range.");
+          return first[i];
+      }
+
+    private:
+      const T * first;
+      std::size_t count;
+  };
+}
+
+#endif
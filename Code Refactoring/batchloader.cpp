@@ -0,0 +1,48 @@
+#include <exception>
+
+#include "parallelfor.h"
+#include "batchloader.h"
+
+using namespace GPS;
+
+namespace
+{
+    // A file that fails to load does not stop the others; its error is kept with its path.
+    template <typename T>
+    std::vector<LoadResult<T>> loadAll(const std::vector<std::string> & filePaths, metres granularity,
+                                       const ParseOptions & options, unsigned int numThreads)
+    {
+        std::vector<LoadResult<T>> results(filePaths.size());
+
+        parallelFor(filePaths.size(), numThreads, [&](std::size_t i)
+        {
+            LoadResult<T> & result = results[i];
+            result.path = filePaths[i];
+            try
+            {
+                result.value.reset(new T(filePaths[i], true, granularity, options));
+            }
+            catch (const std::exception & e)
+            {
+                result.error = e.what();
+            }
+            catch (...)
+            {
+                result.error = "Unknown error.";
+            }
+        });
+        return results;
+    }
+}
+
+std::vector<LoadedRoute> GPS::loadRoutes(const std::vector<std::string> & filePaths, metres granularity,
+                                         const ParseOptions & options, unsigned int numThreads)
+{
+    return loadAll<Route>(filePaths, granularity, options, numThreads);
+}
+
+std::vector<LoadedTrack> GPS::loadTracks(const std::vector<std::string> & filePaths, metres granularity,
+                                         const ParseOptions & options, unsigned int numThreads)
+{
+    return loadAll<Track>(filePaths, granularity, options, numThreads);
+}
@@ -0,0 +1,46 @@
+#ifndef BATCHLOADER_H_211217
+#define BATCHLOADER_H_211217
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "types.h"
+#include "parseoptions.h"
+#include "route.h"
+#include "track.h"
+
+namespace GPS
+{
+  // The outcome of loading one GPX file: either a Route (or Track), or the reason it could not be constructed.
+  template <typename T>
+  struct LoadResult
+  {
+      std::string path;
+      std::unique_ptr<T> value; // Null if construction failed.
+      std::string error;        // The what() of the exception thrown by the constructor, if any.
+
+      bool succeeded() const { return value != nullptr; }
+  };
+
+  typedef LoadResult<Route> LoadedRoute;
+  typedef LoadResult<Track> LoadedTrack;
+
+  /*  Constructs a Route (or Track) from each of the GPX files "filePaths", exactly as the
+   *  Route(path, true, granularity, options) constructor would, spreading the files across
+   *  "numThreads" threads (0 means one per hardware thread).
+   *  The results are in the same order as "filePaths".  An exception thrown while constructing
+   *  one file is recorded in its result rather than propagated, so every file is attempted.
+   */
+  std::vector<LoadedRoute> loadRoutes(const std::vector<std::string> & filePaths,
+                                      metres granularity = 20,
+                                      const ParseOptions & options = ParseOptions(),
+                                      unsigned int numThreads = 0);
+
+  std::vector<LoadedTrack> loadTracks(const std::vector<std::string> & filePaths,
+                                      metres granularity = 10,
+                                      const ParseOptions & options = ParseOptions(),
+                                      unsigned int numThreads = 0);
+}
+
+#endif
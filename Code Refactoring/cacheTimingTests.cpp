@@ -0,0 +1,103 @@
+/*  Timing comparison of reloading a Track from a RouteCache file and from its GPX file.
+ *
+ *  Writes a 1M-point track as GPX and as a cache file, then times reloading each, and checks
+ *  that both give the same Track.  The first load of each file may be slowed by disk reads;
+ *  the figures shown are the best of several runs, so they measure a warm file cache.
+ */
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <algorithm>
+
+#include "routecache.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+namespace
+{
+    // A track heading North in steps of 0-20m, one point per second, with every hundredth point named.
+    std::string makeGPX(unsigned int numPoints)
+    {
+        std::vector<Position> points;
+        std::vector<seconds> times;
+        std::vector<std::string> names;
+        double lat = 52.0;
+        for (unsigned int i = 0; i < numPoints; ++i)
+        {
+            lat += (i % 7) * 0.00003;
+            points.push_back(Position(lat, -1.0, i % 100));
+            times.push_back(i);
+            names.push_back(i % 100 == 0 ? "P" + std::to_string(i) : "");
+        }
+        return GeneratedLogs::trackGPX(points, times, names);
+    }
+
+    template <typename Function>
+    double bestTimeInMilliseconds(unsigned int runs, Function f)
+    {
+        double best = 0;
+        for (unsigned int run = 0; run < runs; ++run)
+        {
+            auto start = std::chrono::steady_clock::now();
+            f();
+            auto finish = std::chrono::steady_clock::now();
+            double time = std::chrono::duration<double, std::milli>(finish - start).count();
+            best = (run == 0) ? time : std::min(best, time);
+        }
+        return best;
+    }
+
+    std::size_t fileSize(const std::string & filePath)
+    {
+        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+        return (std::size_t)file.tellg();
+    }
+}
+
+int main()
+{
+    const unsigned int numPoints = 1000000;
+    const unsigned int runs = 3;
+    const metres granularity = 10;
+    const std::string gpxPath = "cacheTiming.gpx";
+    const std::string cachePath = "cacheTiming.cache";
+
+    {
+        std::ofstream gpxFile(gpxPath);
+        gpxFile << makeGPX(numPoints);
+    }
+    Track original(gpxPath, true, granularity);
+    RouteCache::save(original, cachePath);
+
+    std::string gpxReport, cacheReport;
+    double gpxTime = bestTimeInMilliseconds(runs, [&]()
+    {
+        Track track(gpxPath, true, granularity);
+        gpxReport = track.buildReport();
+    });
+    double cacheTime = bestTimeInMilliseconds(runs, [&]()
+    {
+        std::unique_ptr<Track> track = RouteCache::loadTrack(cachePath);
+        cacheReport = track->buildReport();
+    });
+    // The report is generated on demand, so time the loads alone as well.
+    double gpxLoadTime = bestTimeInMilliseconds(runs, [&]() { Track track(gpxPath, true, granularity); });
+    double cacheLoadTime = bestTimeInMilliseconds(runs, [&]() { RouteCache::loadTrack(cachePath); });
+
+    std::cout << std::setw(8) << "source" << std::setw(14) << "size (MB)" << std::setw(14) << "load (ms)"
+              << std::setw(24) << "load + report (ms)" << std::endl;
+    std::cout << std::setw(8) << "GPX" << std::setw(14) << fileSize(gpxPath) / 1e6
+              << std::setw(14) << gpxLoadTime << std::setw(24) << gpxTime << std::endl;
+    std::cout << std::setw(8) << "cache" << std::setw(14) << fileSize(cachePath) / 1e6
+              << std::setw(14) << cacheLoadTime << std::setw(24) << cacheTime << std::endl;
+    if (gpxReport != cacheReport) std::cout << "MISMATCH between the GPX and cache reports" << std::endl;
+
+    std::remove(gpxPath.c_str());
+    std::remove(cachePath.c_str());
+    return 0;
+}
@@ -0,0 +1,97 @@
+/*  Memory use and access speed of CompressedTrack compared with Track.
+ *
+ *  For a 1M-point track, compares the bytes per point of the compressed points with a Position
+ *  and two "seconds" per point, and times compressing the Track and reading back every point
+ *  from each.  The summary values of a CompressedTrack are copied from the Track, so
+ *  only the points are compared: the furthest any decoded point lies from the original is shown.
+ */
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "compressedtrack.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+namespace
+{
+    // A track heading North-East in steps of 0-20m, with irregular times and elevations.
+    std::string makeGPX(unsigned int numPoints)
+    {
+        std::vector<Position> points;
+        std::vector<seconds> times;
+        double lat = 52.0, lon = -1.0;
+        seconds time = 0;
+        for (unsigned int i = 0; i < numPoints; ++i)
+        {
+            lat += (i % 7) * 0.00003;
+            lon += (i % 5) * 0.00002;
+            time += 1 + i % 3;
+            points.push_back(Position(lat, lon, (i % 100) * 0.5));
+            times.push_back(time);
+        }
+        return GeneratedLogs::trackGPX(points, times);
+    }
+
+    template <typename Function>
+    double timeInMilliseconds(Function f)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto finish = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(finish - start).count();
+    }
+
+    // Reads every point, so that the work cannot be optimised away.
+    template <typename T>
+    double readAll(const T & track)
+    {
+        double sum = 0;
+        for (unsigned int i = 0; i < track.numPositions(); ++i)
+        {
+            const Position pos = track[i];
+            sum += pos.latitude() + pos.longitude() + pos.elevation();
+        }
+        return sum;
+    }
+}
+
+int main()
+{
+    const unsigned int numPoints = 1000000;
+    const metres granularity = 5;
+    Track track(makeGPX(numPoints), false, granularity);
+
+    std::vector<CompressedTrack> compressedTracks;
+    double compressTime = timeInMilliseconds([&]() { compressedTracks.emplace_back(track); });
+    const CompressedTrack & compressed = compressedTracks.front();
+
+    const double trackBytes = track.numPositions() * (sizeof(Position) + 2 * sizeof(seconds));
+    const double compressedBytes = compressed.memoryUsage();
+
+    std::cout << track.numPositions() << " points, compressed in " << compressTime << "ms" << std::endl;
+    std::cout << std::setw(20) << "bytes per point:" << std::setw(14) << "Track" << std::setw(14) << "Compressed" << std::endl;
+    std::cout << std::setw(20) << "" << std::setw(14) << trackBytes / track.numPositions()
+              << std::setw(14) << compressedBytes / compressed.numPositions()
+              << "  (" << trackBytes / compressedBytes << "x smaller)" << std::endl;
+
+    double trackSum = 0, compressedSum = 0;
+    double trackReadTime = timeInMilliseconds([&]() { trackSum = readAll(track); });
+    double compressedReadTime = timeInMilliseconds([&]() { compressedSum = readAll(compressed); });
+
+    metres furthest = 0;
+    for (unsigned int i = 0; i < track.numPositions(); ++i)
+    {
+        furthest = std::max(furthest, Position::distanceBetween(track[i], compressed[i]));
+    }
+
+    std::cout << std::setw(20) << "(ms)" << std::setw(14) << "Track" << std::setw(14) << "Compressed" << std::endl;
+    std::cout << std::setw(20) << "read every point" << std::setw(14) << trackReadTime << std::setw(14) << compressedReadTime
+              << "  " << std::setprecision(10) << trackSum << " vs " << compressedSum << std::endl;
+    std::cout << "Furthest decoded point: " << furthest << "m from the original" << std::endl;
+    return 0;
+}
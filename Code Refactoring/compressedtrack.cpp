@@ -0,0 +1,165 @@
+#include <cmath>
+#include <stdexcept>
+
+#include "compressedtrack.h"
+
+using namespace GPS;
+
+namespace
+{
+    const double coordinateScale = 1e7; // Quantisation steps per degree.
+    const double elevationScale = 1e3;  // Quantisation steps per metre.
+
+    void appendVarint(std::vector<std::uint8_t> & data, std::uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            data.push_back((std::uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        data.push_back((std::uint8_t)value);
+    }
+
+    std::uint64_t readVarint(const std::uint8_t * & pos)
+    {
+        std::uint64_t value = 0;
+        for (unsigned int shift = 0; ; shift += 7)
+        {
+            const std::uint8_t byte = *pos++;
+            value |= (std::uint64_t)(byte & 0x7F) << shift;
+            if (byte < 0x80) return value;
+        }
+    }
+
+    // Maps small negative and positive differences alike to small unsigned values: 0,-1,1,-2,2... to 0,1,2,3,4...
+    std::uint64_t zigZag(std::int64_t value)
+    {
+        return ((std::uint64_t)value << 1) ^ (std::uint64_t)(value >> 63);
+    }
+
+    std::int64_t unZigZag(std::uint64_t value)
+    {
+        return (std::int64_t)(value >> 1) ^ -(std::int64_t)(value & 1);
+    }
+}
+
+const CompressedTrack::PointState & CompressedTrack::Decoder::next()
+{
+    state.latitude += unZigZag(readVarint(pos));
+    state.longitude += unZigZag(readVarint(pos));
+    state.elevation += unZigZag(readVarint(pos));
+    state.arrived = state.departed + unZigZag(readVarint(pos));
+    state.departed = state.arrived + unZigZag(readVarint(pos));
+    return state;
+}
+
+CompressedTrack::CompressedTrack(const Track & track)
+  : trackName(track.name()),
+    count(track.numPositions()),
+    length(track.totalLength())
+{
+    if (count == 0)
+    {
+        throw std::invalid_argument("Cannot compress a Track with no points.");
+    }
+    finishTime = track.totalTime();
+    restTime = track.restingTime();
+    topSpeed = track.maxSpeed();
+
+    PointState previous = { 0, 0, 0, 0, 0 };
+    blocks.reserve(count / blockSize + 1);
+    data.reserve(count * 8);
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (i % blockSize == 0)
+        {
+            blocks.push_back(BlockStart{ data.size(), previous });
+        }
+
+        const Position & position = track.positions[i];
+        PointState state;
+        state.latitude = std::llround(position.latitude() * coordinateScale);
+        state.longitude = std::llround(position.longitude() * coordinateScale);
+        state.elevation = std::llround(position.elevation() * elevationScale);
+        state.arrived = (std::int64_t)track.arrived[i];
+        state.departed = (std::int64_t)track.departed[i];
+
+        appendVarint(data, zigZag(state.latitude - previous.latitude));
+        appendVarint(data, zigZag(state.longitude - previous.longitude));
+        appendVarint(data, zigZag(state.elevation - previous.elevation));
+        appendVarint(data, zigZag(state.arrived - previous.departed));
+        appendVarint(data, zigZag(state.departed - state.arrived));
+        previous = state;
+    }
+    data.shrink_to_fit();
+}
+
+CompressedTrack::PointState CompressedTrack::stateAt(unsigned int idx) const
+{
+    if (idx >= count)
+    {
+        throw std::out_of_range("Track point index out of range.");
+    }
+    Decoder decoder(data, blocks[idx / blockSize]);
+    for (unsigned int i = idx - idx % blockSize; i < idx; ++i) decoder.next();
+    return decoder.next();
+}
+
+Position CompressedTrack::toPosition(const PointState & state)
+{
+    return Position(state.latitude / coordinateScale, state.longitude / coordinateScale,
+                    state.elevation / elevationScale);
+}
+
+Position CompressedTrack::operator[](unsigned int idx) const
+{
+    return toPosition(stateAt(idx));
+}
+
+seconds CompressedTrack::arrivedAt(unsigned int idx) const
+{
+    return (seconds)stateAt(idx).arrived;
+}
+
+seconds CompressedTrack::departedAt(unsigned int idx) const
+{
+    return (seconds)stateAt(idx).departed;
+}
+
+metres CompressedTrack::totalLength() const
+{
+    return length;
+}
+
+seconds CompressedTrack::totalTime() const
+{
+    return finishTime;
+}
+
+seconds CompressedTrack::restingTime() const
+{
+    return restTime;
+}
+
+seconds CompressedTrack::travellingTime() const
+{
+    return totalTime() - restingTime();
+}
+
+speed CompressedTrack::maxSpeed() const
+{
+    return topSpeed;
+}
+
+speed CompressedTrack::averageSpeed(bool includeRests) const
+{
+    seconds time = (includeRests ? totalTime() : travellingTime());
+    if (time == 0) return 0;
+    else return totalLength() / time;
+}
+
+std::size_t CompressedTrack::memoryUsage() const
+{
+    return sizeof(*this) + trackName.capacity() + data.capacity() + blocks.capacity() * sizeof(BlockStart);
+}
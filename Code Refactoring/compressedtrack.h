@@ -0,0 +1,108 @@
+#ifndef COMPRESSEDTRACK_H_211217
+#define COMPRESSEDTRACK_H_211217
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "types.h"
+#include "position.h"
+#include "track.h"
+
+namespace GPS
+{
+  /*  A read-only snapshot of the points and times of a Track, compressed for keeping many Tracks in memory.
+   *
+   *  This is not a storage mode of Track: it cannot be added to or re-decimated, it keeps no point
+   *  names, and it offers only the queries below.  For anything else, keep or rebuild the Track.
+   *
+   *  Coordinates are quantised to 1e-7 degrees and elevations to millimetres, so each Position
+   *  returned is within about 1cm of the original.  Each point is stored as the zig-zag varint
+   *  differences of its quantised coordinates, arrival time and departure time from those of the
+   *  previous point; typically this takes under 10 bytes a point.  Every "blockSize" points an index
+   *  entry records where the next block starts, so operator[] decodes at most one block.
+   *
+   *  The summary values are not computed from the compressed points.  The total length, total time,
+   *  resting time and maximum speed are copied from the Track when compressing it, so they are exactly
+   *  those of the Track; travellingTime() and averageSpeed() are derived from them as Track derives them.
+   */
+  class CompressedTrack
+  {
+    public:
+      static const unsigned int blockSize = 64;
+
+      // Throws a std::invalid_argument exception if the Track has no points.
+      explicit CompressedTrack(const Track &);
+
+      std::string name() const { return trackName; }
+
+      unsigned int numPositions() const { return count; }
+
+      // Return the track point at the specified index.
+      // Throws a std::out_of_range exception if out-of-range.
+      Position operator[](unsigned int) const;
+
+      // The arrival and departure times at the specified track point, relative to the start of the Track.
+      // Throw a std::out_of_range exception if out-of-range.
+      seconds arrivedAt(unsigned int) const;
+      seconds departedAt(unsigned int) const;
+
+      // As for the Track when it was compressed.
+      metres totalLength() const;
+      seconds totalTime() const;
+      seconds restingTime() const;
+      seconds travellingTime() const;
+      speed maxSpeed() const;
+      speed averageSpeed(bool includeRests) const;
+
+      // The number of bytes of memory used by the compressed points and their index.
+      std::size_t memoryUsage() const;
+
+    private:
+      // The quantised values of a point, which are what is delta-encoded.
+      struct PointState
+      {
+          std::int64_t latitude;  // 1e-7 degrees
+          std::int64_t longitude; // 1e-7 degrees
+          std::int64_t elevation; // millimetres
+          std::int64_t arrived;
+          std::int64_t departed;
+      };
+
+      // Where a block's encoded points start, and the state of the point before it.
+      struct BlockStart
+      {
+          std::size_t offset;
+          PointState previous;
+      };
+
+      // Decodes the points following a BlockStart, one at a time.
+      class Decoder
+      {
+        public:
+          Decoder(const std::vector<std::uint8_t> & data, const BlockStart & start)
+            : pos(data.data() + start.offset), state(start.previous) {}
+
+          const PointState & next();
+
+        private:
+          const std::uint8_t * pos;
+          PointState state;
+      };
+
+      std::string trackName;
+      unsigned int count;
+      metres length;
+      seconds finishTime;
+      seconds restTime;
+      speed topSpeed;
+      std::vector<std::uint8_t> data;
+      std::vector<BlockStart> blocks;
+
+      PointState stateAt(unsigned int) const;
+      static Position toPosition(const PointState &);
+  };
+}
+
+#endif
@@ -0,0 +1,65 @@
+/*  Timing comparison of changing the granularity of a Track.
+ *
+ *  Compares Track::setGranularity(), which re-decimates the source points held in memory,
+ *  against reconstructing the Track from its GPX data at the new granularity, for a
+ *  1M-point track.
+ */
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "track.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+namespace
+{
+    // A track heading North in steps of 0-20m, one point per second.
+    std::string makeGPX(unsigned int numPoints)
+    {
+        std::vector<Position> points;
+        std::vector<seconds> times;
+        double lat = 52.0;
+        for (unsigned int i = 0; i < numPoints; ++i)
+        {
+            lat += (i % 7) * 0.00003;
+            points.push_back(Position(lat, -1.0, i % 100));
+            times.push_back(i);
+        }
+        return GeneratedLogs::trackGPX(points, times);
+    }
+
+    template <typename Function>
+    double timeInMilliseconds(Function f)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto finish = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(finish - start).count();
+    }
+}
+
+int main()
+{
+    const unsigned int numPoints = 1000000;
+    const metres granularities[] = { 10, 25, 50, 100, 5 };
+    const std::string gpx = makeGPX(numPoints);
+
+    Track track(gpx, false, granularities[0]);
+
+    std::cout << std::setw(12) << "granularity" << std::setw(10) << "points"
+              << std::setw(24) << "setGranularity (ms)" << std::setw(22) << "reconstruct (ms)" << std::endl;
+
+    for (metres granularity : granularities)
+    {
+        double changeTime = timeInMilliseconds([&]() { track.setGranularity(granularity); });
+        double reconstructTime = timeInMilliseconds([&]() { Track rebuilt(gpx, false, granularity); });
+
+        std::cout << std::setw(12) << granularity << std::setw(10) << track.numPositions()
+                  << std::setw(24) << changeTime << std::setw(22) << reconstructTime << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,28 @@
+#include "levelofdetail.h"
+
+using namespace GPS;
+
+std::vector<std::vector<unsigned int>> GPS::buildDetailLevels(const std::vector<unsigned int> & finest, metres granularity,
+                                                              const std::function<std::vector<unsigned int>(metres)> & decimate)
+{
+    std::vector<std::vector<unsigned int>> levels(1, finest);
+
+    if (granularity <= 0 || finest.empty()) return levels; // Doubling would never discard anything.
+
+    // Once the spacing exceeds half the Earth's circumference only the end points can remain.
+    const unsigned int end = finest.back();
+    metres spacing = granularity;
+    while (levels.back().size() > 2)
+    {
+        spacing *= 2;
+        std::vector<unsigned int> coarser = decimate(spacing);
+
+        // The points that the decimation keeps beyond the end of the finest level are all within
+        // "granularity" of its end, which replaces them.
+        while (! coarser.empty() && coarser.back() >= end) coarser.pop_back();
+        coarser.push_back(end);
+
+        levels.push_back(std::move(coarser));
+    }
+    return levels;
+}
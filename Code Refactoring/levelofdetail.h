@@ -0,0 +1,56 @@
+#ifndef LEVELOFDETAIL_H_211217
+#define LEVELOFDETAIL_H_211217
+
+#include <vector>
+#include <cstddef>
+#include <functional>
+
+#include "types.h"
+#include "position.h"
+#include "arrayview.h"
+
+namespace GPS
+{
+  /*  A subset of the points read for a Route, for drawing it at a reduced level of detail.
+   *  The view refers to the Route's own copy of those points, so it is invalidated if the Route changes.
+   */
+  class DetailLevel
+  {
+    public:
+      DetailLevel(const std::vector<Position> & positions, ArrayView<unsigned int> indices, metres spacing)
+        : positions(&positions), indices(indices), minSpacing(spacing) {}
+
+      // The number of points at this level.
+      std::size_t size() const { return indices.size(); }
+
+      // The i'th point at this level.
+      const Position & operator[](std::size_t i) const { return (*positions)[indices[i]]; }
+
+      // The index, among all the points read from the GPX data, of the i'th point at this level.
+      unsigned int sourceIndex(std::size_t i) const { return indices[i]; }
+
+      // Successive points at this level are at least this far apart, apart from the final point.
+      metres spacing() const { return minSpacing; }
+
+    private:
+      const std::vector<Position> * positions;
+      ArrayView<unsigned int> indices;
+      metres minSpacing;
+  };
+
+  /*  Builds successively coarser levels of detail by repeatedly doubling the granularity.
+   *
+   *  Each level is a list of indices of source points, in ascending order.  Level 0 is "finest", the
+   *  points kept at "granularity".  Level k holds the points that decimate(granularity * 2^k) keeps,
+   *  which are those a Route would keep at that granularity, except that the end of the finest level
+   *  is always the end of each level; any points the decimation keeps beyond it are within
+   *  "granularity" of it.  The first point is kept at every level anyway.
+   *
+   *  Levels are added until one holds no more than two points.  Each takes a decimation of every
+   *  source point, so building them all takes O(n log(length / granularity)) time.
+   */
+  std::vector<std::vector<unsigned int>> buildDetailLevels(const std::vector<unsigned int> & finest, metres granularity,
+                                                           const std::function<std::vector<unsigned int>(metres)> & decimate);
+}
+
+#endif
@@ -0,0 +1,80 @@
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GPS_HAS_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "mappedfile.h"
+
+using namespace GPS;
+
+namespace
+{
+    const char noContents[1] = { '\0' }; // Where an empty or closed file's view points, so that it is never null.
+}
+
+bool MappedFile::open(const std::string & filePath)
+{
+    close();
+
+#ifdef GPS_HAS_MMAP
+    int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || ! S_ISREG(info.st_mode))
+    {
+        ::close(fd);
+        return false;
+    }
+    length = (std::size_t)info.st_size;
+
+    if (length > 0)
+    {
+        void * address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED)
+        {
+            ::madvise(address, length, MADV_SEQUENTIAL); // The parser reads front to back.
+            data = static_cast<const char *>(address);
+            mapped = true;
+        }
+    }
+    ::close(fd);
+    if (mapped || length == 0) return true;
+    length = 0; // The mapping failed; the buffer below sets the length if it can be read.
+#endif
+
+    // No mapping available: read the file once into a buffer sized to fit.
+    std::ifstream fs(filePath, std::ios::binary | std::ios::ate);
+    if (! fs.good()) return false;
+
+    std::streamoff fileSize = fs.tellg();
+    if (fileSize < 0) return false;
+    buffer.resize((std::size_t)fileSize);
+    fs.seekg(0);
+    if (fileSize > 0 && ! fs.read(&buffer[0], fileSize))
+    {
+        close();
+        return false;
+    }
+
+    data = buffer.data();
+    length = buffer.size();
+    return true;
+}
+
+void MappedFile::close()
+{
+#ifdef GPS_HAS_MMAP
+    if (mapped) ::munmap(const_cast<char *>(data), length);
+#endif
+    data = noContents;
+    length = 0;
+    mapped = false;
+    buffer.clear();
+    buffer.shrink_to_fit();
+}
@@ -0,0 +1,42 @@
+#ifndef MAPPEDFILE_H_211217
+#define MAPPEDFILE_H_211217
+
+#include <string>
+#include <cstddef>
+
+#include "textview.h"
+
+namespace GPS
+{
+  /*  A read-only view of the whole contents of a file.
+   *  Where the platform supports it the file is memory-mapped, so nothing is copied;
+   *  otherwise it is read once into a single buffer of the right size.
+   */
+  class MappedFile
+  {
+    public:
+      MappedFile() : data(nullptr), length(0), mapped(false) { close(); }
+      ~MappedFile() { close(); }
+
+      // Opens the file, replacing any file already open.  Returns false, leaving no file open, if the file cannot be read.
+      bool open(const std::string & filePath);
+      void close();
+
+      const char * begin() const { return data; }
+      std::size_t size() const { return length; }
+
+      // The contents of the file; only valid while the file remains open.  Never null, even for an empty or unopened file.
+      TextView view() const { return TextView(data, data + length); }
+
+    private:
+      MappedFile(const MappedFile &) = delete;
+      MappedFile & operator=(const MappedFile &) = delete;
+
+      const char * data;
+      std::size_t length;
+      bool mapped;       // Was "data" obtained from mmap(), or does it point into "buffer"?
+      std::string buffer;
+  };
+}
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef NAMEPOOL_H_211217
+#define NAMEPOOL_H_211217
+
+#include <string>
+#include <cstdint>
+#include <cstring>
+
+#include "textview.h"
+
+namespace GPS
+{
+  // A name stored in a NamePool.  The empty name is {0,0}, and takes no space in the pool.
+  struct NameHandle
+  {
+      std::uint32_t offset;
+      std::uint32_t length;
+
+      bool empty() const { return length == 0; }
+  };
+
+  /*  The characters of many names, stored back to back in a single buffer, so that each name costs
+   *  one NameHandle rather than a std::string (and often a heap allocation) of its own.
+   *  Handles remain valid until the pool is cleared.
+   */
+  class NamePool
+  {
+    public:
+      NameHandle add(TextView name)
+      {
+          if (name.empty()) return NameHandle{ 0, 0 };
+          NameHandle handle{ (std::uint32_t)chars.size(), (std::uint32_t)name.size() };
+          chars.append(name.first, name.size());
+          return handle;
+      }
+
+      NameHandle add(const std::string & name) { return add(TextView(name)); }
+
+      std::string str(NameHandle handle) const { return std::string(chars, handle.offset, handle.length); }
+
+      bool equals(NameHandle handle, const std::string & name) const
+      {
+          return handle.length == name.size()
+              && std::memcmp(chars.data() + handle.offset, name.data(), handle.length) == 0;
+      }
+
+      void clear() { chars.clear(); }
+
+      // The total number of characters stored, and the buffer holding them.
+      std::size_t size() const { return chars.size(); }
+      const char * data() const { return chars.data(); }
+
+      // Replaces the contents of the pool with "size" characters copied from a previous data().
+      void assign(const char * first, std::size_t size) { chars.assign(first, size); }
+
+    private:
+      std::string chars;
+  };
+}
+
+#endif
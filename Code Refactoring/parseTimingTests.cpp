@@ -0,0 +1,116 @@
+/*  Timing comparison of GPX route parsing.
+ *
+ *  Compares the forward-only tokenizer used by Route::parseSource against the previous
+ *  erase-based parse (getAndEraseElement on the front of the source string), for routes
+ *  of 1k, 10k, 100k and 1M points.  The erase-based parse is quadratic, so by default it
+ *  is only timed up to 100k points; pass "--full" to time it at 1M points as well.
+ */
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "xmlparser.h"
+#include "route.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+namespace
+{
+    // A route heading North-East in ~30m steps, with every tenth point named.
+    std::string makeGPX(unsigned int numPoints)
+    {
+        std::vector<Position> points;
+        std::vector<std::string> names;
+        for (unsigned int i = 0; i < numPoints; ++i)
+        {
+            points.push_back(Position(52.0 + i * 0.0002, -1.0 + i * 0.0002, i % 100));
+            names.push_back(i % 10 == 0 ? "P" + std::to_string(i) : "");
+        }
+        return GeneratedLogs::routeGPX(points, names);
+    }
+
+    // The route parse as it was before the tokenizer: every <rtept> is erased from the front of the source.
+    std::vector<Position> legacyParse(std::string source, metres granularity)
+    {
+        using namespace XML::Parser;
+
+        std::vector<Position> positions;
+        std::string element = getElement(source, "gpx");
+        source = getElementContent(element);
+        element = getElement(source, "rte");
+        source = getElementContent(element);
+        if (elementExists(source, "name")) getAndEraseElement(source, "name");
+
+        while (elementExists(source, "rtept"))
+        {
+            element = getAndEraseElement(source, "rtept");
+            std::string lat = getElementAttribute(element, "lat");
+            std::string lon = getElementAttribute(element, "lon");
+            std::string content = getElementContent(element);
+            Position pos = elementExists(content, "ele")
+                         ? Position(lat, lon, getElementContent(getElement(content, "ele")))
+                         : Position(lat, lon);
+            if (positions.empty() || Position::distanceBetween(pos, positions.back()) >= granularity)
+            {
+                positions.push_back(pos);
+            }
+        }
+        return positions;
+    }
+
+    template <typename Function>
+    double timeInMilliseconds(Function f)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto finish = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(finish - start).count();
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    const bool full = (argc > 1 && std::string(argv[1]) == "--full");
+    const unsigned int sizes[] = { 1000, 10000, 100000, 1000000 };
+    const metres granularity = 20;
+
+    std::cout << std::setw(10) << "points" << std::setw(16) << "tokenizer (ms)" << std::setw(16) << "erase (ms)" << std::endl;
+
+    for (unsigned int numPoints : sizes)
+    {
+        const std::string gpx = makeGPX(numPoints);
+
+        unsigned int tokenized = 0;
+        double tokenizerTime = timeInMilliseconds([&]()
+        {
+            Route route(gpx, false, granularity);
+            tokenized = route.numPositions();
+        });
+
+        std::cout << std::setw(10) << numPoints << std::setw(16) << tokenizerTime;
+
+        if (numPoints <= 100000 || full)
+        {
+            std::size_t erased = 0;
+            double eraseTime = timeInMilliseconds([&]()
+            {
+                erased = legacyParse(gpx, granularity).size();
+            });
+            std::cout << std::setw(16) << eraseTime;
+            if (erased != tokenized)
+            {
+                std::cout << "  MISMATCH: " << erased << " vs " << tokenized << " positions";
+            }
+        }
+        else
+        {
+            std::cout << std::setw(16) << "skipped";
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,31 @@
+#ifndef PARSEOPTIONS_H_211217
+#define PARSEOPTIONS_H_211217
+
+namespace GPS
+{
+  /*  How a Route holds its points, in addition to the Position objects returned by operator[].
+   *
+   *  The Position objects cannot be replaced by the arrays: operator[] returns them, the decimation
+   *  copies them from the source points, and the segment table, indexes and build report are made
+   *  from them.  The arrays are a contiguous copy for callers that process the coordinates in bulk
+   *  (see Route::latitudes()), and for the bounding box.  Every query gives the same result either way.
+   */
+  enum class PositionStorage
+  {
+      Objects, // Only the std::vector<Position>.
+      Arrays   // Also separate contiguous latitude, longitude and elevation arrays.
+  };
+
+  // Options controlling how Routes and Tracks are constructed from GPX data.
+  struct ParseOptions
+  {
+      PositionStorage storage = PositionStorage::Objects;
+
+      /* The number of threads used to read the track points of a Track (0 means one per hardware thread).
+       * The points are decimated serially afterwards, so the result does not depend on this.
+       */
+      unsigned int threads = 1;
+  };
+}
+
+#endif
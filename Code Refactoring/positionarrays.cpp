@@ -0,0 +1,366 @@
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define GPS_VECTOR_LANES
+#include <immintrin.h>
+#endif
+
+#include "geometry.h"
+#include "positionarrays.h"
+
+using namespace GPS;
+
+void PositionArrays::assign(const std::vector<Position> & positions)
+{
+    latitudes.resize(positions.size());
+    longitudes.resize(positions.size());
+    elevations.resize(positions.size());
+
+    for (std::size_t i = 0; i < positions.size(); ++i)
+    {
+        latitudes[i] = positions[i].latitude();
+        longitudes[i] = positions[i].longitude();
+        elevations[i] = positions[i].elevation();
+    }
+}
+
+void PositionArrays::clear()
+{
+    latitudes.clear();
+    longitudes.clear();
+    elevations.clear();
+}
+
+namespace
+{
+    // The angle subtended at the centre of the Earth by two points, from the chord between their unit vectors.
+    radians centralAngle(const Position & p1, const Position & p2)
+    {
+        radians lat1 = degToRad(p1.latitude()), lon1 = degToRad(p1.longitude());
+        radians lat2 = degToRad(p2.latitude()), lon2 = degToRad(p2.longitude());
+        double dx = std::cos(lat1) * std::cos(lon1) - std::cos(lat2) * std::cos(lon2);
+        double dy = std::cos(lat1) * std::sin(lon1) - std::cos(lat2) * std::sin(lon2);
+        double dz = std::sin(lat1) - std::sin(lat2);
+        return 2 * std::asin(std::sqrt(dx * dx + dy * dy + dz * dz) / 2);
+    }
+}
+
+metres GPS::distanceRadius()
+{
+    static const metres radius = []()
+    {
+        const Position origin(0, 0, 0), quarter(0, 90, 0);
+        const metres r = Position::distanceBetween(origin, quarter) / centralAngle(origin, quarter);
+
+        const Position from(45, 10, 0), to(50, 20, 0);
+        const metres oblique = Position::distanceBetween(from, to);
+        return (std::abs(oblique - r * centralAngle(from, to)) <= 1e-9 * oblique) ? r : 0.0;
+    }();
+    return radius;
+}
+
+/*  The distance kernel converts each point to a unit vector once, then takes the great-circle
+ *  distance of each step from the chord between successive vectors:  d = 2R asin(|p2 - p1| / 2).
+ *  This is the haversine formula rearranged so that the trigonometry is per point, not per step.
+ *
+ *  sin, cos and asin are evaluated with the Cephes polynomial approximations (accurate to about
+ *  one unit in the last place) so that they can run in vector registers.  Angles are quartered
+ *  before evaluation and then doubled twice, which keeps the polynomials inside |x| <= pi/4 for
+ *  every valid latitude and longitude without any further range reduction.
+ *
+ *  The arithmetic is written once, as templates over a "lane" type with the usual operators,
+ *  and instantiated for plain doubles and for whichever vector registers are available.
+ */
+namespace
+{
+    const double sinCoefficients[] = {
+         1.58962301576546568060E-10, -2.50507477628578072866E-8,  2.75573136213857245213E-6,
+        -1.98412698295895385996E-4,   8.33333333332211858878E-3, -1.66666666666666307295E-1 };
+    const double cosCoefficients[] = {
+        -1.13585365213876817300E-11,  2.08757008419747316778E-9, -2.75573141792967388112E-7,
+         2.48015872888517045348E-5,  -1.38888888888730564116E-3,  4.16666666666665929218E-2 };
+
+    // asin(x) = x + x^3 P(x^2)/Q(x^2) for 0 <= x <= 0.625
+    const double asinP[] = {
+         4.253011369004428248960E-3, -6.019598008014123785661E-1,  5.444622390564711410273E0,
+        -1.626247967210700244449E1,   1.956261983317594739197E1,  -8.198089802484824371615E0 };
+    const double asinQ[] = {
+         1.0,                        -1.474091372988853791896E1,   7.049610280856842141659E1,
+        -1.471791292232726029859E2,   1.395105614657485689735E2,  -4.918853881490881290097E1 };
+
+    // asin(1-x) = pi/2 - sqrt(2x)(1 + x R(x)/S(x)) for 0 <= x < 0.375
+    const double asinR[] = {
+         2.967721961301243206100E-3, -5.634242780008963776856E-1,  6.968710824104713396794E0,
+        -2.556901049652824852289E1,   2.853665548261061424989E1 };
+    const double asinS[] = {
+         1.0,                        -2.194779531642920639778E1,   1.470656354026814941758E2,
+        -3.838770957603691357202E2,   3.424398657913078477438E2 };
+
+    const double quarterPi = 7.85398163397448309616E-1;
+    const double quarterPiLowBits = 6.123233995736765886130E-17;
+
+    // ---- Lane types ----
+
+    inline double squareRoot(double x) { return std::sqrt(x); }
+    inline double lesser(double a, double b) { return a < b ? a : b; }
+    inline double greater(double a, double b) { return a > b ? a : b; }
+    inline double selectIfAbove(double x, double limit, double ifAbove, double otherwise)
+    {
+        return x > limit ? ifAbove : otherwise;
+    }
+    inline double loadLanes(const double * p, double) { return *p; }
+    inline void storeLanes(double * p, double v) { *p = v; }
+
+#ifdef GPS_VECTOR_LANES
+    struct Sse2Lanes
+    {
+        __m128d v;
+        Sse2Lanes() {}
+        Sse2Lanes(__m128d v) : v(v) {}
+        Sse2Lanes(double x) : v(_mm_set1_pd(x)) {}
+        static const std::size_t width = 2;
+    };
+    inline Sse2Lanes operator+(Sse2Lanes a, Sse2Lanes b) { return _mm_add_pd(a.v, b.v); }
+    inline Sse2Lanes operator-(Sse2Lanes a, Sse2Lanes b) { return _mm_sub_pd(a.v, b.v); }
+    inline Sse2Lanes operator*(Sse2Lanes a, Sse2Lanes b) { return _mm_mul_pd(a.v, b.v); }
+    inline Sse2Lanes operator/(Sse2Lanes a, Sse2Lanes b) { return _mm_div_pd(a.v, b.v); }
+    inline Sse2Lanes squareRoot(Sse2Lanes x) { return _mm_sqrt_pd(x.v); }
+    inline Sse2Lanes lesser(Sse2Lanes a, Sse2Lanes b) { return _mm_min_pd(a.v, b.v); }
+    inline Sse2Lanes greater(Sse2Lanes a, Sse2Lanes b) { return _mm_max_pd(a.v, b.v); }
+    inline Sse2Lanes selectIfAbove(Sse2Lanes x, Sse2Lanes limit, Sse2Lanes ifAbove, Sse2Lanes otherwise)
+    {
+        __m128d mask = _mm_cmpgt_pd(x.v, limit.v);
+        return _mm_or_pd(_mm_and_pd(mask, ifAbove.v), _mm_andnot_pd(mask, otherwise.v));
+    }
+    inline Sse2Lanes loadLanes(const double * p, Sse2Lanes) { return _mm_loadu_pd(p); }
+    inline void storeLanes(double * p, Sse2Lanes x) { _mm_storeu_pd(p, x.v); }
+#endif
+
+#if defined(__AVX2__)
+    struct Avx2Lanes
+    {
+        __m256d v;
+        Avx2Lanes() {}
+        Avx2Lanes(__m256d v) : v(v) {}
+        Avx2Lanes(double x) : v(_mm256_set1_pd(x)) {}
+        static const std::size_t width = 4;
+    };
+    inline Avx2Lanes operator+(Avx2Lanes a, Avx2Lanes b) { return _mm256_add_pd(a.v, b.v); }
+    inline Avx2Lanes operator-(Avx2Lanes a, Avx2Lanes b) { return _mm256_sub_pd(a.v, b.v); }
+    inline Avx2Lanes operator*(Avx2Lanes a, Avx2Lanes b) { return _mm256_mul_pd(a.v, b.v); }
+    inline Avx2Lanes operator/(Avx2Lanes a, Avx2Lanes b) { return _mm256_div_pd(a.v, b.v); }
+    inline Avx2Lanes squareRoot(Avx2Lanes x) { return _mm256_sqrt_pd(x.v); }
+    inline Avx2Lanes lesser(Avx2Lanes a, Avx2Lanes b) { return _mm256_min_pd(a.v, b.v); }
+    inline Avx2Lanes greater(Avx2Lanes a, Avx2Lanes b) { return _mm256_max_pd(a.v, b.v); }
+    inline Avx2Lanes selectIfAbove(Avx2Lanes x, Avx2Lanes limit, Avx2Lanes ifAbove, Avx2Lanes otherwise)
+    {
+        return _mm256_blendv_pd(otherwise.v, ifAbove.v, _mm256_cmp_pd(x.v, limit.v, _CMP_GT_OQ));
+    }
+    inline Avx2Lanes loadLanes(const double * p, Avx2Lanes) { return _mm256_loadu_pd(p); }
+    inline void storeLanes(double * p, Avx2Lanes x) { _mm256_storeu_pd(p, x.v); }
+
+    typedef Avx2Lanes WidestLanes;
+#elif defined(GPS_VECTOR_LANES)
+    typedef Sse2Lanes WidestLanes;
+#endif
+
+    template <typename Lanes> std::size_t laneCount() { return Lanes::width; }
+    template <> std::size_t laneCount<double>() { return 1; }
+
+    // ---- Kernels, written once for any lane type ----
+
+    template <typename Lanes, std::size_t N>
+    Lanes polynomial(Lanes x, const double (&coefficients)[N])
+    {
+        Lanes result = coefficients[0];
+        for (std::size_t i = 1; i < N; ++i) result = result * x + coefficients[i];
+        return result;
+    }
+
+    // sin and cos of an angle (radians) in the range [-pi, pi].
+    template <typename Lanes>
+    void sinCos(Lanes angle, Lanes & sine, Lanes & cosine)
+    {
+        Lanes x = angle * 0.25;
+        Lanes xx = x * x;
+        Lanes s = x + x * xx * polynomial(xx, sinCoefficients);
+        Lanes c = Lanes(1.0) - xx * 0.5 + xx * xx * polynomial(xx, cosCoefficients);
+
+        for (int doubling = 0; doubling < 2; ++doubling)
+        {
+            Lanes s2 = (s + s) * c;
+            c = (c - s) * (c + s);
+            s = s2;
+        }
+        sine = s;
+        cosine = c;
+    }
+
+    // asin(x) for x in the range [0, 1].
+    template <typename Lanes>
+    Lanes arcSin(Lanes x)
+    {
+        Lanes xx = x * x;
+        Lanes nearZero = x * (xx * polynomial(xx, asinP) / polynomial(xx, asinQ)) + x;
+
+        Lanes z = Lanes(1.0) - x;
+        Lanes p = z * polynomial(z, asinR) / polynomial(z, asinS);
+        Lanes root = squareRoot(z + z);
+        Lanes nearOne = ((Lanes(quarterPi) - root) - (root * p - quarterPiLowBits)) + quarterPi;
+
+        return selectIfAbove(x, Lanes(0.625), nearOne, nearZero);
+    }
+
+    template <typename Lanes>
+    void toUnitVectors(const degrees * latitudes, const degrees * longitudes, std::size_t count,
+                       double * xs, double * ys, double * zs)
+    {
+        const std::size_t width = laneCount<Lanes>();
+        const double toRadians = degToRad(1.0);
+
+        for (std::size_t i = 0; i < count; i += width)
+        {
+            Lanes sinLat, cosLat, sinLon, cosLon;
+            sinCos(loadLanes(latitudes + i, Lanes()) * toRadians, sinLat, cosLat);
+            sinCos(loadLanes(longitudes + i, Lanes()) * toRadians, sinLon, cosLon);
+            storeLanes(xs + i, cosLat * cosLon);
+            storeLanes(ys + i, cosLat * sinLon);
+            storeLanes(zs + i, sinLat);
+        }
+    }
+
+    template <typename Lanes>
+    void chordDistances(const double * xs, const double * ys, const double * zs, std::size_t count,
+                        metres radius, metres * distances)
+    {
+        const std::size_t width = laneCount<Lanes>();
+        const Lanes diameter = 2 * radius;
+
+        for (std::size_t i = 0; i < count; i += width)
+        {
+            Lanes dx = loadLanes(xs + i + 1, Lanes()) - loadLanes(xs + i, Lanes());
+            Lanes dy = loadLanes(ys + i + 1, Lanes()) - loadLanes(ys + i, Lanes());
+            Lanes dz = loadLanes(zs + i + 1, Lanes()) - loadLanes(zs + i, Lanes());
+            Lanes halfChord = lesser(squareRoot(dx * dx + dy * dy + dz * dz) * 0.5, Lanes(1.0));
+            storeLanes(distances + i, diameter * arcSin(halfChord));
+        }
+    }
+
+    template <typename Lanes>
+    void rangeOf(const double * values, std::size_t count, double & lowest, double & highest)
+    {
+        const std::size_t width = laneCount<Lanes>();
+        Lanes low = loadLanes(values, Lanes()), high = low;
+
+        for (std::size_t i = width; i + width <= count; i += width)
+        {
+            Lanes v = loadLanes(values + i, Lanes());
+            low = lesser(low, v);
+            high = greater(high, v);
+        }
+        double lows[4], highs[4];
+        storeLanes(lows, low);
+        storeLanes(highs, high);
+        lowest = *std::min_element(lows, lows + width);
+        highest = *std::max_element(highs, highs + width);
+    }
+
+    // The points are processed in blocks, so that the unit vectors stay in the L1 cache.
+    const std::size_t blockSize = 512;
+}
+
+void GPS::distancesBetweenSuccessive(const degrees * latitudes, const degrees * longitudes,
+                                     std::size_t count, metres * distances)
+{
+    if (count < 2) return;
+
+    double lowest, highest;
+    valueRange(latitudes, count, lowest, highest);
+    bool inRange = (lowest >= -halfRotation / 2 && highest <= halfRotation / 2);
+    valueRange(longitudes, count, lowest, highest);
+    inRange = inRange && (lowest >= -halfRotation && highest <= halfRotation);
+    const metres radius = distanceRadius();
+
+    // The polynomials are only accurate for normalised coordinates, and chords only measure distances on a sphere.
+    if (! inRange || radius == 0)
+    {
+        for (std::size_t i = 1; i < count; ++i)
+        {
+            distances[i - 1] = Position::distanceBetween(Position(latitudes[i - 1], longitudes[i - 1]),
+                                                         Position(latitudes[i], longitudes[i]));
+        }
+        return;
+    }
+
+    double xs[blockSize + 1], ys[blockSize + 1], zs[blockSize + 1];
+
+    for (std::size_t first = 0; first + 1 < count; first += blockSize)
+    {
+        const std::size_t points = std::min(blockSize + 1, count - first);
+        const std::size_t steps = points - 1;
+        std::size_t vectorPoints = 0, vectorSteps = 0;
+
+#ifdef GPS_VECTOR_LANES
+        vectorPoints = points - points % WidestLanes::width;
+        toUnitVectors<WidestLanes>(latitudes + first, longitudes + first, vectorPoints, xs, ys, zs);
+#endif
+        toUnitVectors<double>(latitudes + first + vectorPoints, longitudes + first + vectorPoints,
+                              points - vectorPoints, xs + vectorPoints, ys + vectorPoints, zs + vectorPoints);
+
+#ifdef GPS_VECTOR_LANES
+        vectorSteps = steps - steps % WidestLanes::width;
+        chordDistances<WidestLanes>(xs, ys, zs, vectorSteps, radius, distances + first);
+#endif
+        chordDistances<double>(xs + vectorSteps, ys + vectorSteps, zs + vectorSteps, steps - vectorSteps,
+                               radius, distances + first + vectorSteps);
+    }
+}
+
+void GPS::unitVectors(const degrees * latitudes, const degrees * longitudes, std::size_t count,
+                      double * xs, double * ys, double * zs)
+{
+    if (count == 0) return;
+
+    double lowest, highest;
+    valueRange(latitudes, count, lowest, highest);
+    bool inRange = (lowest >= -halfRotation / 2 && highest <= halfRotation / 2);
+    valueRange(longitudes, count, lowest, highest);
+    inRange = inRange && (lowest >= -halfRotation && highest <= halfRotation);
+
+    if (! inRange)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            radians lat = degToRad(latitudes[i]), lon = degToRad(longitudes[i]);
+            xs[i] = std::cos(lat) * std::cos(lon);
+            ys[i] = std::cos(lat) * std::sin(lon);
+            zs[i] = std::sin(lat);
+        }
+        return;
+    }
+
+    std::size_t vectorCount = 0;
+#ifdef GPS_VECTOR_LANES
+    vectorCount = count - count % WidestLanes::width;
+    toUnitVectors<WidestLanes>(latitudes, longitudes, vectorCount, xs, ys, zs);
+#endif
+    toUnitVectors<double>(latitudes + vectorCount, longitudes + vectorCount, count - vectorCount,
+                          xs + vectorCount, ys + vectorCount, zs + vectorCount);
+}
+
+void GPS::valueRange(const double * values, std::size_t count, double & lowest, double & highest)
+{
+    std::size_t vectorCount = 0;
+    lowest = highest = values[0];
+
+#ifdef GPS_VECTOR_LANES
+    vectorCount = count - count % WidestLanes::width;
+    if (vectorCount > 0) rangeOf<WidestLanes>(values, vectorCount, lowest, highest);
+#endif
+    for (std::size_t i = vectorCount; i < count; ++i)
+    {
+        lowest = std::min(lowest, values[i]);
+        highest = std::max(highest, values[i]);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef POSITIONARRAYS_H_211217
+#define POSITIONARRAYS_H_211217
+
+#include <vector>
+#include <cstddef>
+
+#include "types.h"
+#include "position.h"
+
+namespace GPS
+{
+  // The coordinates of a sequence of Positions, stored as one contiguous array per coordinate.
+  struct PositionArrays
+  {
+      std::vector<degrees> latitudes;
+      std::vector<degrees> longitudes;
+      std::vector<metres> elevations;
+
+      void assign(const std::vector<Position> &);
+      void clear();
+      std::size_t size() const { return latitudes.size(); }
+  };
+
+  /*  Bulk kernels over coordinate arrays.
+   *
+   *  These are vectorised with AVX2 when compiled with it enabled (e.g. -mavx2 or -march=native),
+   *  otherwise with SSE2 on x86-64, and otherwise run one value at a time.  All three produce
+   *  identical results.
+   */
+
+  /*  The radius of the sphere on which Position::distanceBetween() measures, found from the length
+   *  of a quarter of the Equator rather than assumed to be Earth::meanRadius.  Returns 0 if a second,
+   *  oblique distance does not fit a sphere of that radius (e.g. an ellipsoidal distance).
+   */
+  metres distanceRadius();
+
+  /*  Stores the horizontal distance between each pair of successive points in "distances",
+   *  which must have room for count-1 values.  The distances are measured on the sphere of
+   *  distanceRadius(), and agree with Position::distanceBetween() to within about one part in 10^8;
+   *  if distanceBetween() is not spherical, it is used for every step instead.
+   *
+   *  Being approximate, these are not used for the analytics of a Route, which must not depend on
+   *  how its points are stored; they are for bulk processing of the arrays by callers.
+   */
+  void distancesBetweenSuccessive(const degrees * latitudes, const degrees * longitudes,
+                                  std::size_t count, metres * distances);
+
+  /*  Converts each point to a unit vector from the centre of the Earth, storing its components in
+   *  "xs", "ys" and "zs", which must each have room for "count" values.  Two points are d metres
+   *  apart when their unit vectors are a chord of 2 sin(d / 2R) apart.
+   */
+  void unitVectors(const degrees * latitudes, const degrees * longitudes, std::size_t count,
+                   double * xs, double * ys, double * zs);
+
+  // Finds the lowest and highest of "count" (> 0) values.
+  void valueRange(const double * values, std::size_t count, double & lowest, double & highest);
+}
+
+#endif
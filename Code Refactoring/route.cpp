@@ -1,5 +1,4 @@
 #include <sstream>
-#include <fstream>
 #include <iostream>
 #include <cassert>
 #include <cmath>
@@ -7,11 +6,25 @@
 #include <algorithm>
 
 #include "geometry.h"
-#include "xmlparser.h"
+#include "xmltokenizer.h"
 #include "route.h"
 
 using namespace GPS;
 
+Segment Segment::between(const Position & from, const Position & to)
+{
+    Segment segment;
+    segment.deltaH = Position::distanceBetween(to, from);
+    segment.deltaV = to.elevation() - from.elevation();
+    segment.gradient = radToDeg(std::atan(segment.deltaV / segment.deltaH));
+    return segment;
+}
+
+metres Segment::length() const
+{
+    return std::sqrt(std::pow(deltaH, 2) + std::pow(deltaV, 2));
+}
+
 std::string Route::name() const
 {
     return routeName.empty() ? "Unnamed Route" : routeName;
@@ -43,15 +56,7 @@ metres Route::netLength() const
 
 metres Route::totalHeightGain() const
 {
-    assert(!positions.empty());
-
-    metres total = 0.0;
-    for (unsigned int i = 1; i < numPositions(); ++i)
-    {
-        metres deltaV = positions[i].elevation() - positions[i - 1].elevation();
-        if (deltaV > 0.0) total += deltaV; // ignore negative height differences
-    }
-    return total;
+    return statistics().totalHeightGain;
 }
 
 metres Route::netHeightGain() const
@@ -68,131 +73,74 @@ degrees Route::minLatitude() const
         throw std::out_of_range("Cannot get the minimum latitude of an empty route");
     }
 
-    degrees lowestLatitude = positions[0].latitude();
-
-    double epsilon = 0.0001;
-
-    for (int i = 0; i < positions.size(); i++)
-    {
-        if ((positions[i].latitude() - lowestLatitude) < epsilon)
-        {
-            lowestLatitude = positions[i].latitude();
-        }
-    }
-
-    return lowestLatitude;
+    return statistics().minLatitude;
 }
 
 degrees Route::maxLatitude() const
 {
-    degrees currentMax = positions[0].latitude();
-
-    for (int i = 0; i < positions.size(); i++) {
-        if (positions[i].latitude() > currentMax)
-            currentMax = positions[i].latitude();
-    }
-
-    return currentMax;
+    return statistics().maxLatitude;
 }
 
 degrees Route::minLongitude() const     //MY FUNCTION
 {
-    assert(!positions.empty());
-
-    degrees minLon = positions.front().longitude();
-    for (const Position& pos : positions)
-    {
-        minLon = std::min(minLon, pos.longitude());
-    }
-    return minLon;
+    return statistics().minLongitude;
 }
 
 degrees Route::maxLongitude() const
 {
-    assert(!positions.empty());
-
-    degrees maxLon = positions.front().longitude();
-    for (const Position& pos : positions)
-    {
-        maxLon = std::max(maxLon, pos.longitude());
-    }
-    return maxLon;
-
+    return statistics().maxLongitude;
 }
 
 metres Route::minElevation() const
 {
-    assert(!positions.empty());
-
-    degrees minEle = positions.front().elevation();
-    for (const Position& pos : positions)
-    {
-        minEle = std::min(minEle, pos.elevation());
-    }
-    return minEle;
+    return statistics().minElevation;
 }
 
 metres Route::maxElevation() const
 {
-    assert(!positions.empty());
-
-    degrees maxEle = positions.front().elevation();
-    for (const Position& pos : positions)
-    {
-        maxEle = std::max(maxEle, pos.elevation());
-    }
-    return maxEle;
+    return statistics().maxElevation;
 }
 
 degrees Route::maxGradient() const
 {
-    assert(!positions.empty());
-
-    if (positions.size() == 1) return 0.0;
-
-    degrees maxGrad = -halfRotation / 2; // minimum possible value
-    for (unsigned int i = 1; i < positions.size(); ++i)
-    {
-        metres deltaH = Position::distanceBetween(positions[i], positions[i - 1]);
-        metres deltaV = positions[i].elevation() - positions[i - 1].elevation();
-        degrees grad = radToDeg(std::atan(deltaV / deltaH));
-        maxGrad = std::max(maxGrad, grad);
-    }
-    return maxGrad;
+    return statistics().maxGradient;
 }
 
 degrees Route::minGradient() const
 {
-    assert(!positions.empty());
+    return statistics().minGradient;
+}
 
-    if (positions.size() == 1) return 0.0;
+degrees Route::steepestGradient() const
+{
+    return statistics().steepestGradient;
+}
 
-    degrees minGrad = halfRotation / 2; // maximum possible value
-    for (unsigned int i = 1; i < positions.size(); ++i)
+const RouteStatistics & Route::statistics() const
+{
+    if (! statisticsCached)
     {
-        metres deltaH = Position::distanceBetween(positions[i], positions[i - 1]);
-        metres deltaV = positions[i].elevation() - positions[i - 1].elevation();
-        degrees grad = radToDeg(std::atan(deltaV / deltaH));
-        minGrad = std::min(minGrad, grad);
+        computeStatistics();
+        statisticsCached = true;
     }
-    return minGrad;
+    return cachedStatistics;
 }
 
-degrees Route::steepestGradient() const
+DetailLevel Route::levelOfDetail(metres tolerance) const
 {
-    assert(!positions.empty());
-
-    if (positions.size() == 1) return 0.0;
+    if (detailLevels.empty())
+    {
+        auto decimate = [this](metres spacing) { return keptSourceIndices(spacing); };
+        detailLevels = buildDetailLevels(keptSourceIndices(granularity), granularity, decimate);
+    }
 
-    degrees maxGrad = -halfRotation / 2; // minimum possible value
-    for (unsigned int i = 1; i < positions.size(); ++i)
+    // Level k has a spacing of granularity * 2^k.
+    std::size_t level = 0;
+    if (granularity > 0 && tolerance >= 2 * granularity)
     {
-        metres deltaH = Position::distanceBetween(positions[i], positions[i - 1]);
-        metres deltaV = positions[i].elevation() - positions[i - 1].elevation();
-        degrees grad = radToDeg(std::atan(deltaV / deltaH));
-        maxGrad = std::max(maxGrad, std::abs(grad));
+        level = std::min(detailLevels.size() - 1, (std::size_t)std::floor(std::log2(tolerance / granularity)));
     }
-    return maxGrad;
+    return DetailLevel(sourcePositions, detailLevels[level], granularity * std::pow(2.0, (double)level));
 }
 
 Position Route::operator[](unsigned int idx) const
@@ -202,84 +150,149 @@ Position Route::operator[](unsigned int idx) const
 
 Position Route::findPosition(const std::string & soughtName) const
 {
-    auto nameIt = std::find(positionNames.begin(), positionNames.end(), soughtName);
+    const auto & names = namedPositions();
+    auto nameIt = names.find(soughtName);
 
-    if (nameIt == positionNames.end())
+    if (nameIt == names.end())
     {
         throw std::out_of_range("No position with that name found in the route.");
     }
     else
     {
-        return positions[std::distance(positionNames.begin(), nameIt)];
+        return positions[nameIt->second.index];
     }
 }
 
 std::string Route::findNameOf(const Position & soughtPos) const
 {
-    auto posIt = std::find_if(positions.begin(), positions.end(),
-        [&](const Position& pos) {return areSameLocation(pos, soughtPos); });
+    // The first route point within "granularity", as a linear search would find.
+    const unsigned int notFound = (unsigned int)positions.size();
+    unsigned int first = notFound;
+
+    if (granularity > 0) {
+        spatialIndex().forEachNear(soughtPos, [&](unsigned int i)
+        {
+            if (i < first && areSameLocation(positions[i], soughtPos)) first = i;
+        });
+    }
 
-    if (posIt == positions.end())
+    if (first == notFound)
     {
         throw std::out_of_range("Position not found in route.");
     }
     else
     {
-        return positionNames[std::distance(positions.begin(), posIt)];
+        return names.str(positionNames[first]);
     }
 }
 
 unsigned int Route::timesVisited(const std::string & soughtName) const
 {
-    unsigned int timesVisited{ 0 };
-
-    try {
+    const auto & names = namedPositions();
+    auto nameIt = names.find(soughtName);
 
-        Position position = this->findPosition(soughtName);
-        for (const auto &i : positions)
-            if (areSameLocation(i, position)) timesVisited++;
-
-    }
-    catch (const std::out_of_range& e) {}
-
-    return timesVisited;
+    return nameIt == names.end() ? 0 : nameIt->second.timesVisited;
 }
 
 unsigned int Route::timesVisited(const Position & soughtPos) const
 {
     unsigned int timesVisited{ 0 };
 
-    for (const auto &i : positions)
-        if (areSameLocation(i, soughtPos)) timesVisited++;
+    if (granularity > 0) {
+        spatialIndex().forEachNear(soughtPos, [&](unsigned int i)
+        {
+            if (areSameLocation(positions[i], soughtPos)) timesVisited++;
+        });
+    }
 
     return timesVisited;
 }
 
 std::string Route::buildReport() const
 {
-    return report;
+    std::ostringstream reportStr;
+    reportStr << report;
+    reportDecimation(reportStr, keptSourceIndices(reportGranularity));
+    return reportStr.str();
 }
 
 //Constructs a route
 //If isFileName is false then route is constructed from the data in string source
 //Otherwise the route is constructed from the data contained inside the file referenced by source
-Route::Route(std::string source, bool isFileName, metres granularity)
+Route::Route(const std::string & source, bool isFileName, metres granularity, const ParseOptions & options)
 {
 
 
     this->granularity = granularity;
+    this->reportGranularity = granularity;
+    this->storage = options.storage;
 
     if (isFileName) {  //If source is a filename, process as a file
-        std::string filePath = source;
-        loadFileToSource(filePath, source);
+        MappedFile file;
+        loadFileToSource(source, file);
+        parseSource(file.view());
+    }
+    else {
+        parseSource(TextView(source));
     }
 
-    parseSource(source);
+    decimate();
+
+    buildSegments();
     calcRouteLength();
 }
 
 //------------------- protected methods ---------------------
 
+void Route::invalidateCaches()
+{
+    statisticsCached = false;
+    discardIndexes();
+}
+
+void Route::appendPosition(const Position & position)
+{
+    positions.push_back(position);
+    positionNames.push_back(NameHandle{ 0, 0 });
+    if (storage == PositionStorage::Arrays) {
+        positionArrays.latitudes.push_back(position.latitude());
+        positionArrays.longitudes.push_back(position.longitude());
+        positionArrays.elevations.push_back(position.elevation());
+    }
+    discardIndexes();
+
+    const std::size_t last = positions.size() - 1;
+    if (last == 0) return;
+
+    // As buildSegments() and calcRouteLength().
+    segmentTable.push_back(Segment::between(positions[last - 1], positions[last]));
+    const Segment & segment = segmentTable.back();
+    routeLength += segment.length();
+
+    // As computeStatistics().
+    if (statisticsCached) {
+        RouteStatistics & stats = cachedStatistics;
+
+        stats.minLatitude = std::min(stats.minLatitude, position.latitude());
+        stats.maxLatitude = std::max(stats.maxLatitude, position.latitude());
+        stats.minLongitude = std::min(stats.minLongitude, position.longitude());
+        stats.maxLongitude = std::max(stats.maxLongitude, position.longitude());
+        stats.minElevation = std::min(stats.minElevation, position.elevation());
+        stats.maxElevation = std::max(stats.maxElevation, position.elevation());
+
+        if (last == 1) {
+            stats.maxGradient = -halfRotation / 2;
+            stats.minGradient = halfRotation / 2;
+            stats.steepestGradient = -halfRotation / 2;
+        }
+        if (segment.deltaV > 0.0) stats.totalHeightGain += segment.deltaV;
+
+        stats.maxGradient = std::max(stats.maxGradient, segment.gradient);
+        stats.minGradient = std::min(stats.minGradient, segment.gradient);
+        stats.steepestGradient = std::max(stats.steepestGradient, std::abs(segment.gradient));
+    }
+}
+
 bool Route::areSameLocation(const Position & p1, const Position & p2) const
 {
     return (Position::distanceBetween(p1, p2) < granularity);
@@ -287,177 +300,306 @@ bool Route::areSameLocation(const Position & p1, const Position & p2) const
 
 //------------------- private helper methods ---------------------
 
-void Route::appendToReport(const std::ostringstream & value)
+void Route::discardIndexes()
 {
-    report += value.str();
+    detailLevels.clear();
+    locationIndex.clear();
+    nameIndex.clear();
+    nameIndexBuilt = false;
 }
 
-void Route::loadFileToSource(const std::string &filePath, std::string & source)
+const SpatialIndex & Route::spatialIndex() const
 {
+    if (! locationIndex.isBuilt())
+    {
+        locationIndex.build(positions, granularity);
+    }
+    return locationIndex;
+}
 
-    std::string temp;
-    std::ostringstream oss;
-    std::ostringstream reportStr;
-    std::ifstream fs(filePath);
-
-    if (!fs.good()) {
-        throw std::invalid_argument("Error opening source file '" + filePath + "'.");
+const std::unordered_map<std::string, Route::NamedPosition> & Route::namedPositions() const
+{
+    if (! nameIndexBuilt)
+    {
+        nameIndex.clear();
+        nameIndex.reserve(positionNames.size());
+        for (unsigned int i = 0; i < positionNames.size(); ++i)
+        {
+            // Only the first point with each name is found by findPosition().
+            auto inserted = nameIndex.insert({ names.str(positionNames[i]), NamedPosition{ i, 0 } });
+            if (inserted.second)
+            {
+                inserted.first->second.timesVisited = timesVisited(positions[i]);
+            }
+        }
+        nameIndexBuilt = true;
     }
-    reportStr << "Source file '" << filePath << "' opened okay." << std::endl;
+    return nameIndex;
+}
+
+void Route::computeStatistics() const
+{
+    assert(!positions.empty());
 
-    while (fs.good()) {
-        getline(fs, temp);
-        oss << temp << std::endl;
+    RouteStatistics & stats = cachedStatistics;
+    const Position & start = positions.front();
+    const bool useArrays = (storage == PositionStorage::Arrays);
+
+    if (useArrays) {
+        valueRange(positionArrays.latitudes.data(), positionArrays.size(), stats.minLatitude, stats.maxLatitude);
+        valueRange(positionArrays.longitudes.data(), positionArrays.size(), stats.minLongitude, stats.maxLongitude);
+        valueRange(positionArrays.elevations.data(), positionArrays.size(), stats.minElevation, stats.maxElevation);
+    }
+    else {
+        stats.minLatitude = stats.maxLatitude = start.latitude();
+        stats.minLongitude = stats.maxLongitude = start.longitude();
+        stats.minElevation = stats.maxElevation = start.elevation();
     }
-    source = oss.str();
+    stats.totalHeightGain = 0.0;
 
-    while (fs.good()) {
-        getline(fs, temp);
-        oss << temp << std::endl;
+    if (positions.size() == 1)
+    {
+        stats.maxGradient = stats.minGradient = stats.steepestGradient = 0.0;
+        return;
     }
+    assert(segmentTable.size() == positions.size() - 1);
 
-    source = oss.str(); //return source data loaded from file using pass by reference
-    appendToReport(reportStr);
+    stats.maxGradient = -halfRotation / 2; // minimum possible value
+    stats.minGradient = halfRotation / 2; // maximum possible value
+    stats.steepestGradient = -halfRotation / 2;
+
+    for (unsigned int i = 1; i < positions.size(); ++i)
+    {
+        if (! useArrays) {
+            const Position & pos = positions[i];
+
+            stats.minLatitude = std::min(stats.minLatitude, pos.latitude());
+            stats.maxLatitude = std::max(stats.maxLatitude, pos.latitude());
+            stats.minLongitude = std::min(stats.minLongitude, pos.longitude());
+            stats.maxLongitude = std::max(stats.maxLongitude, pos.longitude());
+            stats.minElevation = std::min(stats.minElevation, pos.elevation());
+            stats.maxElevation = std::max(stats.maxElevation, pos.elevation());
+        }
+
+        const Segment & segment = segmentTable[i - 1];
+        if (segment.deltaV > 0.0) stats.totalHeightGain += segment.deltaV; // ignore negative height differences
+
+        degrees grad = segment.gradient;
+        stats.maxGradient = std::max(stats.maxGradient, grad);
+        stats.minGradient = std::min(stats.minGradient, grad);
+        stats.steepestGradient = std::max(stats.steepestGradient, std::abs(grad));
+    }
 }
 
-void Route::parseSource(std::string &source)
+void Route::appendToReport(const std::ostringstream & value)
 {
-   //Rmove using "namespace std;"
+    report += value.str();
+}
 
-    using namespace XML::Parser;
+void Route::loadFileToSource(const std::string &filePath, MappedFile & file)
+{
+    std::ostringstream reportStr;
 
-    const int MAX = 3; //array size
+    if (! file.open(filePath)) {
+        throw std::invalid_argument("Error opening source file '" + filePath + "'.");
+    }
+    reportStr << "Source file '" << filePath << "' opened okay." << std::endl;
+    appendToReport(reportStr);
+}
 
+void Route::parseSource(TextView source)
+{
+    /* The GPX data is walked once, front to back, with a forward-only tokenizer.
+     * Nothing is erased from or copied out of the source buffer except the short
+     * attribute and element values needed to build each Position.
+     */
+    using namespace XML;
+
+    Element element, child;
+    TextView value;
     std::string lat, lon, ele;
-    std::string tempStorage[MAX]; //Removed temp, temp2, name and convert it into array for temp storage
     std::ostringstream reportStr;
 
-    //unsigned int num = 0; not needed as number of posistion can be called using positionNames.size() vector
-
-    if (!elementExists(source, "gpx")) {
+    if (! findElement(source, "gpx", element)) {
         throw std::domain_error("No 'gpx' element.");
-    } else {
-        tempStorage[0] = getElement(source, "gpx");
-        source = getElementContent(tempStorage[0]);
     }
-
-    if (!elementExists(source, "rte")) {
+    if (! findElement(element.content, "rte", element)) {
         throw std::domain_error("No 'rte' element.");
-    } else {
-        tempStorage[0] = getElement(source, "rte");
-        source = getElementContent(tempStorage[0]);
     }
+    const TextView rteContent = element.content;
 
+    Element rtept;
+    bool hasPoints = findElement(rteContent, "rtept", rtept);
 
-    if (elementExists(source, "name")) {
-        tempStorage[0] = getAndEraseElement(source, "name");
-        routeName = getElementContent(tempStorage[0]);
+    // The route name precedes the route points.
+    TextView header(rteContent.first, hasPoints ? rtept.openingTag.first : rteContent.last);
+    if (findElement(header, "name", element)) {
+        element.content.assignTo(routeName);
         reportStr << "Route name is: " << routeName << std::endl;
+        appendToReport(reportStr);
     }
 
-    if (!elementExists(source, "rtept")) {
+    if (! hasPoints) {
         throw std::domain_error("No 'rtept' element.");
-    } else {
-        tempStorage[0] = getAndEraseElement(source, "rtept");
     }
 
-    if (!attributeExists(tempStorage[0], "lat")) {
-        throw std::domain_error("No 'lat' attribute.");
-
-    } else if (!attributeExists(tempStorage[0], "lon")) {
-        throw std::domain_error("No 'lon' attribute.");
-
-    } else {
-        lat = getElementAttribute(tempStorage[0], "lat");
-        lon = getElementAttribute(tempStorage[0], "lon");
-        tempStorage[0] = getElementContent(tempStorage[0]);
-    }
+    Tokenizer points(TextView(rtept.openingTag.first, rteContent.last));
 
+    while (points.next("rtept", rtept)) {
+        if (! findAttribute(rtept, "lat", value)) {
+            throw std::domain_error("No 'lat' attribute.");
+        }
+        value.assignTo(lat);
+        if (! findAttribute(rtept, "lon", value)) {
+            throw std::domain_error("No 'lon' attribute.");
+        }
+        value.assignTo(lon);
 
-    if (elementExists(tempStorage[0], "ele")) {
-        tempStorage[1] = getElement(tempStorage[0], "ele");
-        ele = getElementContent(tempStorage[1]);
-        Position startPos = Position(lat, lon, ele);
-        positions.push_back(startPos);
-        reportStr << "Position added: " << startPos.toString() << std::endl;
-
-    }
-    else {
-        Position startPos = Position(lat, lon);
-        positions.push_back(startPos);
-        reportStr << "Position added: " << startPos.toString() <<  std::endl;
+        if (findElement(rtept.content, "ele", child)) {
+            child.content.assignTo(ele);
+            sourcePositions.push_back(Position(lat, lon, ele));
+        }
+        else sourcePositions.push_back(Position(lat, lon));
 
+        if (findElement(rtept.content, "name", child)) {
+            sourceNames.push_back(std::make_pair((unsigned int)sourcePositions.size() - 1, names.add(child.content)));
+        }
     }
+}
 
-    if (elementExists(tempStorage[0], "name")) {
-        tempStorage[0] = getElement(tempStorage[0], "name");
-        tempStorage[2] = getElementContent(tempStorage[0]);
+std::vector<unsigned int> Route::keptSourceIndices(metres granularity) const
+{
+    /* Each source point is compared with the last point kept.  Rather than a haversine per
+     * comparison, the points are converted to unit vectors once, and the chord between them is
+     * compared with the chord that spans "granularity" on the sphere that distanceBetween() uses.
+     * Only a chord within a hair's breadth of that threshold falls back to the haversine distance,
+     * so the result is exactly the same.  If distanceBetween() is not spherical, it is always used.
+     */
+    const std::size_t count = sourcePositions.size();
+    std::vector<unsigned int> kept;
+    if (count == 0) return kept;
+    kept.push_back(0);
+
+    const metres radius = distanceRadius();
+    const double threshold = (radius > 0) ? 2 * std::sin(granularity / (2 * radius)) : 0;
+    const double margin = 1e-9; // About 6mm; far larger than any rounding in the unit vectors or the haversine.
+    const bool useChords = (granularity < 1e6 && threshold > 2 * margin);
+
+    if (! useChords) {
+        for (unsigned int i = 1; i < count; ++i) {
+            if (Position::distanceBetween(sourcePositions[i], sourcePositions[kept.back()]) >= granularity) kept.push_back(i);
+        }
+        return kept;
     }
 
-    positionNames.push_back(tempStorage[2]);
-    Position prevPos = positions.back(), nextPos = positions.back();
+    const double sameBelow = (threshold - margin) * (threshold - margin);
+    const double differentAbove = (threshold + margin) * (threshold + margin);
 
-    while (elementExists(source, "rtept")) {
-        tempStorage[0] = getAndEraseElement(source, "rtept");
+    // The unit vectors are computed a block at a time, so the working set stays small.
+    const std::size_t blockSize = 1024;
+    double lats[blockSize], lons[blockSize], xs[blockSize], ys[blockSize], zs[blockSize];
+    double lastX = 0, lastY = 0, lastZ = 0;
+    unsigned int last = 0;
 
-        if (!attributeExists(tempStorage[0], "lat")) {
-            throw std::domain_error("No 'lat' attribute.");
-        }
-        if (!attributeExists(tempStorage[0], "lon")) {
-            throw std::domain_error("No 'lon' attribute.");
-        }
-        lat = getElementAttribute(tempStorage[0], "lat");
-        lon = getElementAttribute(tempStorage[0], "lon");
-        tempStorage[0] = getElementContent(tempStorage[0]);
-
-        if (elementExists(tempStorage[0], "ele")) {
-            tempStorage[1] = getElement(tempStorage[0], "ele");
-            ele = getElementContent(tempStorage[1]);
-            nextPos = Position(lat, lon, ele);
+    for (std::size_t first = 0; first < count; first += blockSize) {
+        const std::size_t points = std::min(blockSize, count - first);
+        for (std::size_t j = 0; j < points; ++j) {
+            lats[j] = sourcePositions[first + j].latitude();
+            lons[j] = sourcePositions[first + j].longitude();
         }
-        else nextPos = Position(lat, lon);
+        unitVectors(lats, lons, points, xs, ys, zs);
 
-        if (areSameLocation(nextPos, prevPos)) {
-            reportStr << "Position ignored: " << nextPos.toString() << std::endl;
-        }
-        else {
-            if (elementExists(tempStorage[0], "name")) {
-                tempStorage[1] = getElement(tempStorage[0], "name");
-                tempStorage[2] = getElementContent(tempStorage[1]);
-            }
-            else tempStorage[2] = ""; // Fixed bug by adding this.
-            positions.push_back(nextPos);
-            positionNames.push_back(tempStorage[2]);
-            reportStr << "Position added: " << nextPos.toString() << std::endl;
+        for (std::size_t j = 0; j < points; ++j) {
+            const unsigned int i = (unsigned int)(first + j);
 
-            prevPos = nextPos;
+            if (i > 0) {
+                double dx = xs[j] - lastX, dy = ys[j] - lastY, dz = zs[j] - lastZ;
+                double chordSquared = dx * dx + dy * dy + dz * dz;
+
+                bool same = (chordSquared < sameBelow) ? true
+                          : (chordSquared > differentAbove) ? false
+                          : Position::distanceBetween(sourcePositions[i], sourcePositions[last]) < granularity;
+                if (same) continue;
+                kept.push_back(i);
+            }
+            last = i;
+            lastX = xs[j];
+            lastY = ys[j];
+            lastZ = zs[j];
         }
     }
-    reportStr << positionNames.size() << " positions added." << std::endl;
-    appendToReport(reportStr);
+    return kept;
 }
 
-void Route::calcRouteLength(void)
+void Route::decimate()
 {
+    keepSourcePoints(keptSourceIndices(granularity));
+}
 
-    metres deltaH, deltaV;
+void Route::keepSourcePoints(const std::vector<unsigned int> & kept)
+{
+    positions.clear();
+    positionNames.clear();
+    positions.reserve(kept.size());
+    positionNames.reserve(kept.size());
 
-    routeLength = 0;
+    auto nextName = sourceNames.begin();
+
+    for (unsigned int i : kept) {
+        while (nextName != sourceNames.end() && nextName->first < i) ++nextName;
+        bool named = (nextName != sourceNames.end() && nextName->first == i);
 
-    for (size_t i = 1; i < positionNames.size(); ++i) {
-        deltaH = Position::distanceBetween(positions[i - 1], positions[i]);
-        deltaV = positions[i - 1].elevation() - positions[i].elevation();
-        routeLength += deltaH /*removed sqrt and pow */+ pow(deltaV, 2);
+        positions.push_back(sourcePositions[i]);
+        positionNames.push_back(named ? nextName->second : NameHandle{ 0, 0 });
     }
 }
 
-void Route::setGranularity(metres granularity)
+void Route::reportDecimation(std::ostream & reportStr, const std::vector<unsigned int> & kept) const
 {
-    bool implemented = false;
-    assert(implemented);
+    auto nextKept = kept.begin();
+
+    for (unsigned int i = 0; i < sourcePositions.size(); ++i) {
+        const Position & nextPos = sourcePositions[i];
+
+        if (nextKept == kept.end() || *nextKept != i) {
+            reportStr << "Position ignored: " << nextPos.toString() << std::endl;
+            continue;
+        }
+        ++nextKept;
+        reportStr << "Position added: " << nextPos.toString() << std::endl;
+    }
+    reportStr << kept.size() << " positions added." << std::endl;
 }
 
+void Route::buildSegments()
+{
+    segmentTable.clear();
+    segmentTable.resize(positions.empty() ? 0 : positions.size() - 1);
 
+    if (storage == PositionStorage::Arrays) positionArrays.assign(positions);
 
+    // The distances come from distanceBetween() whatever the storage, so that every analytic is the same either way.
+    for (size_t i = 1; i < positions.size(); ++i) {
+        segmentTable[i - 1] = Segment::between(positions[i - 1], positions[i]);
+    }
+    invalidateCaches();
+}
 
+void Route::calcRouteLength(void)
+{
+    routeLength = 0;
+
+    for (const Segment & segment : segmentTable) {
+        routeLength += segment.length();
+    }
+}
+
+void Route::setGranularity(metres granularity)
+{
+    // The source points are kept, so the Route can be re-decimated without reparsing.
+    this->granularity = granularity;
 
+    decimate();
+    buildSegments();
+    calcRouteLength();
+}
@@ -3,25 +3,67 @@
 
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include <utility>
 #include <sstream>
 #include <iostream>
 
 #include "types.h"
 #include "position.h"
+#include "textview.h"
+#include "mappedfile.h"
+#include "arrayview.h"
+#include "parseoptions.h"
+#include "positionarrays.h"
+#include "levelofdetail.h"
+#include "spatialindex.h"
+#include "namepool.h"
 
 namespace GPS
 {
+  // Summary values of a Route, gathered together in a single pass over its points.
+  struct RouteStatistics
+  {
+      degrees minLatitude;
+      degrees maxLatitude;
+      degrees minLongitude;
+      degrees maxLongitude;
+      metres minElevation;
+      metres maxElevation;
+      metres totalHeightGain;
+      degrees maxGradient;
+      degrees minGradient;
+      degrees steepestGradient;
+  };
+
+  // The step between two successive points of a Route.
+  struct Segment
+  {
+      metres deltaH;    // Horizontal distance between the points.
+      metres deltaV;    // Change in elevation; positive if uphill.
+      degrees gradient; // Uphill gradient of the step; negative if downhill.
+
+      // The step from one point to the next.
+      static Segment between(const Position & from, const Position & to);
+
+      // The straight-line length of the step, counting the change in elevation.
+      metres length() const;
+  };
+
   class Route
   {
     public:
       /*  Routes are constructed from GPX data.  The data can be provided as a string, or from a file.
        *  Any route points closer together than a certain minimum distance are discarded.
        */
-      Route(std::string source,
+      Route(const std::string & source,
             bool isFileName, // Is the first parameter a file name or a string containing GPX data?
-            metres granularity = 20); // The minimum distance between successive route points.
+            metres granularity = 20, // The minimum distance between successive route points.
+            const ParseOptions & options = ParseOptions());
 
-      // Returns a report of the construction process; useful for debugging purposes.
+      /* Returns a report of the construction process; useful for debugging purposes.
+       * The report is generated on each call, so constructing a Route does no formatting for it.
+       */
       std::string buildReport() const;
 
       /* Update the granularity of the stored Route.  Any position in the Route that differs in distance
@@ -78,6 +120,28 @@ namespace GPS
       // The elevation of the highest point on the Route.
       metres maxElevation() const;
 
+      /* All of the above summary values.  They are computed together on the first query and
+       * cached, so this is not safe to call for the first time from several threads at once.
+       */
+      const RouteStatistics & statistics() const;
+
+      /* The steps between successive route points; element i runs from point i to point i+1.
+       * The view remains valid for the lifetime of the Route, until its granularity changes.
+       */
+      ArrayView<Segment> segments() const { return segmentTable; }
+
+      // The coordinates of every route point, one array per coordinate.
+      // These are empty unless the Route was constructed with PositionStorage::Arrays.
+      ArrayView<degrees> latitudes() const { return positionArrays.latitudes; }
+      ArrayView<degrees> longitudes() const { return positionArrays.longitudes; }
+      ArrayView<metres> elevations() const { return positionArrays.elevations; }
+
+      /* The route points at the coarsest level of detail whose spacing does not exceed "tolerance":
+       * the points setGranularity() would keep at that spacing, ending at the last route point;
+       * see buildDetailLevels().  The levels are built on the first call, after which each call is O(1).
+       */
+      DetailLevel levelOfDetail(metres tolerance) const;
+
       // Return the route point at the specified index.
       // Throws a std::out_of_range exception if out-of-range.
       Position operator[](unsigned int) const;
@@ -91,7 +155,8 @@ namespace GPS
       std::string findNameOf(const Position &) const;
 
       void calcRouteLength(void);
-      void loadFileToSource(const std::string &filePath, std::string & source);
+      // Opens the GPX file for parsing; the contents remain valid while "file" is open.
+      void loadFileToSource(const std::string &filePath, MappedFile & file);
 
 
 
@@ -105,16 +170,64 @@ namespace GPS
 
     protected:
 
-      Route() {} // Only called by Track constructor.
+      friend class RouteCache;
+
+      Route() {} // Only called by Track constructor and RouteCache.
 
       metres granularity;
 
       metres routeLength;
       std::string routeName;
       std::vector<Position> positions;
-      std::vector<std::string> positionNames;
+      std::vector<NameHandle> positionNames; // The characters are held in "names".
+
+      /* Every point read from the GPX data, before any were discarded for being within "granularity"
+       * of their predecessor; kept so that the granularity can be changed without reparsing.
+       * Only named points have an entry in "sourceNames", which is ordered by index.
+       */
+      std::vector<Position> sourcePositions;
+      std::vector<std::pair<unsigned int, NameHandle>> sourceNames;
+
+      // The names of the source points; "positionNames" refer to the same characters.
+      NamePool names;
 
+      PositionStorage storage = PositionStorage::Objects;
+      PositionArrays positionArrays; // Only filled for PositionStorage::Arrays; a copy of "positions".
+
+      /* The report lines from reading the GPX data.  The lines for each point added or ignored are
+       * not stored; buildReport() regenerates them from the source points at "reportGranularity",
+       * the granularity at construction.
+       */
       std::string report;
+      metres reportGranularity;
+
+      // The Segments between successive "positions"; rebuilt by buildSegments().
+      std::vector<Segment> segmentTable;
+
+      // The indices of the source points that are not within "granularity" of the previous point kept.
+      std::vector<unsigned int> keptSourceIndices(metres granularity) const;
+
+      // Rebuilds "positions" and "positionNames" from the source points at the current granularity.
+      void decimate();
+
+      // Rebuilds "positions" and "positionNames" from the source points listed in "kept".
+      virtual void keepSourcePoints(const std::vector<unsigned int> & kept);
+
+      // Reports each source point as added or ignored, according to "kept" (from keptSourceIndices()).
+      virtual void reportDecimation(std::ostream & reportStr, const std::vector<unsigned int> & kept) const;
+
+      /* Recomputes "segmentTable" (and "positionArrays", if used) from "positions".
+       * The analytics all read distances from the table.
+       */
+      void buildSegments();
+
+      // Discards the cached statistics and indexes; must be called whenever "positions" changes.
+      virtual void invalidateCaches();
+
+      /* Adds a point to the end of "positions", extending the segment table, the route length and
+       * (if computed) the statistics in O(1) rather than rebuilding them.
+       */
+      void appendPosition(const Position &);
 
       /* Two Positions are considered to be the same location is they are less than
        * "granularity" metres apart (horizontally).
@@ -123,8 +236,32 @@ namespace GPS
 
 
      private:
+      mutable RouteStatistics cachedStatistics;
+      mutable bool statisticsCached = false;
+      mutable std::vector<std::vector<unsigned int>> detailLevels;
+      mutable SpatialIndex locationIndex;
+
+      // Discards the levels of detail and the spatial and name indexes.
+      void discardIndexes();
+
+      // The spatial index of "positions", built on first use.
+      const SpatialIndex & spatialIndex() const;
+
+      // The first route point bearing a name, and how many times that point is visited.
+      struct NamedPosition
+      {
+          unsigned int index;
+          unsigned int timesVisited;
+      };
+      mutable std::unordered_map<std::string, NamedPosition> nameIndex;
+      mutable bool nameIndexBuilt = false;
+
+      // Every distinct name in "positionNames", built on first use.
+      const std::unordered_map<std::string, NamedPosition> & namedPositions() const;
+
+      void computeStatistics() const;
       void appendToReport(const std::ostringstream & value);
-      void parseSource(std::string &source);
+      void parseSource(TextView source);
 
   };
 }
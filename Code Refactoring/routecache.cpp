@@ -0,0 +1,361 @@
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "mappedfile.h"
+#include "routecache.h"
+
+using namespace GPS;
+
+namespace
+{
+    const char cacheMagic[8] = { 'G', 'P', 'S', 'C', 'A', 'C', 'H', 'E' };
+    const std::uint32_t byteOrderMark = 0x01020304;
+
+    enum CacheKind : std::uint32_t { RouteKind = 0, TrackKind = 1 };
+
+    // The size and modification time of the GPX file a cache was saved from.
+    struct SourceStamp
+    {
+        std::uint64_t size;
+        std::int64_t modified; // In nanoseconds since the epoch, to the file system's resolution.
+
+        bool operator==(const SourceStamp & other) const { return size == other.size && modified == other.modified; }
+    };
+
+    // Recorded when no source file was named.
+    const SourceStamp noSource = { UINT64_MAX, 0 };
+
+    // The start of every cache file; the checksum covers the rest of the header and the payload that follows.
+    struct CacheHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint32_t kind;
+        std::uint32_t storage;
+        std::uint64_t payloadSize;
+        std::uint64_t checksum;
+        SourceStamp source;
+    };
+
+    // The first item of the payload, giving the size of each array that follows it.
+    struct CacheCounts
+    {
+        std::uint64_t sourcePoints;
+        std::uint64_t keptPoints;
+        std::uint64_t sourceNames;
+        std::uint64_t nameChars;
+        std::uint64_t routeNameChars;
+        std::uint64_t reportChars;
+        metres granularity;
+        metres reportGranularity;
+        metres routeLength;
+        RouteStatistics statistics;
+    };
+
+    // Every item in the payload starts on an 8-byte boundary.
+    std::size_t padded(std::size_t bytes)
+    {
+        return (bytes + 7) & ~std::size_t(7);
+    }
+
+    // A 64-bit checksum of "size" (a multiple of 8) bytes, taken a word at a time so that it runs at memory speed.
+    // A checksum can be continued over further bytes by passing it as the "seed".
+    std::uint64_t checksum(const char * data, std::size_t size, std::uint64_t seed = 0x9E3779B97F4A7C15ULL)
+    {
+        std::uint64_t hash = seed;
+        for (std::size_t i = 0; i < size; i += 8)
+        {
+            std::uint64_t word;
+            std::memcpy(&word, data + i, 8);
+            hash = (hash ^ word) * 0xFF51AFD7ED558CCDULL;
+            hash ^= hash >> 29;
+        }
+        return hash ^ size;
+    }
+
+    // The checksum of the header (without the checksum itself) followed by the payload.
+    std::uint64_t checksum(CacheHeader header, const char * payload)
+    {
+        header.checksum = 0;
+        return checksum(payload, header.payloadSize, checksum(reinterpret_cast<const char *>(&header), sizeof(header)));
+    }
+
+    SourceStamp sourceStamp(const std::string & sourceFile)
+    {
+        if (sourceFile.empty()) return noSource;
+
+        struct stat info;
+        if (::stat(sourceFile.c_str(), &info) != 0)
+        {
+            throw std::invalid_argument("Error accessing source file '" + sourceFile + "'.");
+        }
+        std::int64_t modified = (std::int64_t)info.st_mtime * 1000000000;
+#if defined(__APPLE__)
+        modified += info.st_mtimespec.tv_nsec;
+#elif defined(__unix__)
+        modified += info.st_mtim.tv_nsec;
+#endif
+        return SourceStamp{ (std::uint64_t)info.st_size, modified };
+    }
+
+    class PayloadWriter
+    {
+      public:
+        template <typename T>
+        void write(const T * values, std::size_t count)
+        {
+            const std::size_t bytes = count * sizeof(T);
+            if (bytes > 0) buffer.append(reinterpret_cast<const char *>(values), bytes);
+            buffer.append(padded(bytes) - bytes, '\0');
+        }
+
+        template <typename T>
+        void write(const std::vector<T> & values) { write(values.data(), values.size()); }
+
+        template <typename T>
+        void write(const T & value) { write(&value, 1); }
+
+        const std::string & payload() const { return buffer; }
+
+      private:
+        std::string buffer;
+    };
+
+    class PayloadReader
+    {
+      public:
+        PayloadReader(const char * first, const char * last) : pos(first), last(last) {}
+
+        // Returns a pointer to the next "count" values, which remain in the file.
+        template <typename T>
+        const char * next(std::size_t count)
+        {
+            if (count > (std::size_t)(last - pos) / sizeof(T)) corrupt();
+            const char * values = pos;
+            pos += std::min(padded(count * sizeof(T)), (std::size_t)(last - pos));
+            return values;
+        }
+
+        template <typename T>
+        void read(T & value) { std::memcpy(&value, next<T>(1), sizeof(T)); }
+
+        template <typename T>
+        std::vector<T> readVector(std::uint64_t count)
+        {
+            const char * values = next<T>(count);
+            std::vector<T> result(count);
+            if (count > 0) std::memcpy(result.data(), values, count * sizeof(T));
+            return result;
+        }
+
+        [[noreturn]] static void corrupt()
+        {
+            throw std::domain_error("Route cache file is corrupt.");
+        }
+
+      private:
+        const char * pos;
+        const char * last;
+    };
+}
+
+void RouteCache::save(const Route & route, const std::string & filePath, const std::string & sourceFile)
+{
+    if (route.sourcePositions.empty())
+    {
+        throw std::invalid_argument("Cannot cache a Route or Track with no points.");
+    }
+    const Track * track = dynamic_cast<const Track *>(&route);
+
+    const std::vector<unsigned int> kept = route.keptSourceIndices(route.granularity);
+    const std::size_t numSource = route.sourcePositions.size();
+
+    CacheCounts counts;
+    counts.sourcePoints = numSource;
+    counts.keptPoints = kept.size();
+    counts.sourceNames = route.sourceNames.size();
+    counts.nameChars = route.names.size();
+    counts.routeNameChars = route.routeName.size();
+    counts.reportChars = route.report.size();
+    counts.granularity = route.granularity;
+    counts.reportGranularity = route.reportGranularity;
+    counts.routeLength = route.routeLength;
+    counts.statistics = route.statistics();
+
+    std::vector<degrees> latitudes(numSource), longitudes(numSource);
+    std::vector<metres> elevations(numSource);
+    for (std::size_t i = 0; i < numSource; ++i)
+    {
+        latitudes[i] = route.sourcePositions[i].latitude();
+        longitudes[i] = route.sourcePositions[i].longitude();
+        elevations[i] = route.sourcePositions[i].elevation();
+    }
+
+    std::vector<std::uint32_t> nameIndices;
+    std::vector<NameHandle> nameHandles;
+    for (const auto & name : route.sourceNames)
+    {
+        nameIndices.push_back(name.first);
+        nameHandles.push_back(name.second);
+    }
+
+    PayloadWriter writer;
+    writer.write(counts);
+    writer.write(latitudes);
+    writer.write(longitudes);
+    writer.write(elevations);
+    if (track) writer.write(track->sourceTimes);
+    writer.write(kept);
+    writer.write(nameIndices);
+    writer.write(nameHandles);
+    writer.write(route.names.data(), route.names.size());
+    writer.write(route.routeName.data(), route.routeName.size());
+    writer.write(route.report.data(), route.report.size());
+    writer.write(route.segmentTable);
+
+    const std::string & payload = writer.payload();
+
+    CacheHeader header;
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = formatVersion;
+    header.byteOrder = byteOrderMark;
+    header.kind = track ? TrackKind : RouteKind;
+    header.storage = (std::uint32_t)route.storage;
+    header.payloadSize = payload.size();
+    header.source = sourceStamp(sourceFile);
+    header.checksum = checksum(header, payload.data());
+
+    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(payload.data(), (std::streamsize)payload.size());
+    file.close();
+    if (! file)
+    {
+        throw std::invalid_argument("Error writing cache file '" + filePath + "'.");
+    }
+}
+
+std::unique_ptr<Route> RouteCache::loadRoute(const std::string & filePath, const std::string & sourceFile)
+{
+    static_assert(sizeof(unsigned int) == sizeof(std::uint32_t), "Cache files store indices as 32-bit values.");
+
+    MappedFile file;
+    if (! file.open(filePath))
+    {
+        throw std::invalid_argument("Error opening cache file '" + filePath + "'.");
+    }
+
+    CacheHeader header;
+    if (file.size() < sizeof(header))
+    {
+        throw std::domain_error("Not a route cache file.");
+    }
+    std::memcpy(&header, file.begin(), sizeof(header));
+    if (std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0)
+    {
+        throw std::domain_error("Not a route cache file.");
+    }
+    if (header.version != formatVersion || header.byteOrder != byteOrderMark)
+    {
+        throw std::domain_error("Route cache file was written by an incompatible version.");
+    }
+
+    const char * payload = file.begin() + sizeof(header);
+    if (header.payloadSize != file.size() - sizeof(header) || header.payloadSize % 8 != 0
+        || checksum(header, payload) != header.checksum
+        || header.kind > TrackKind || header.storage > (std::uint32_t)PositionStorage::Arrays)
+    {
+        PayloadReader::corrupt();
+    }
+    if (! sourceFile.empty() && ! (header.source == sourceStamp(sourceFile)))
+    {
+        throw std::domain_error("Route cache file is out of date.");
+    }
+
+    PayloadReader reader(payload, payload + header.payloadSize);
+    CacheCounts counts;
+    reader.read(counts);
+
+    Track * track = (header.kind == TrackKind) ? new Track() : nullptr;
+    std::unique_ptr<Route> route(track ? track : new Route());
+
+    route->granularity = counts.granularity;
+    route->reportGranularity = counts.reportGranularity;
+    route->routeLength = counts.routeLength;
+    route->storage = (PositionStorage)header.storage;
+
+    const std::size_t numSource = counts.sourcePoints;
+    const char * latitudes = reader.next<degrees>(numSource);
+    const char * longitudes = reader.next<degrees>(numSource);
+    const char * elevations = reader.next<metres>(numSource);
+    route->sourcePositions.reserve(numSource);
+    for (std::size_t i = 0; i < numSource; ++i)
+    {
+        degrees lat, lon;
+        metres ele;
+        std::memcpy(&lat, latitudes + i * sizeof(degrees), sizeof(degrees));
+        std::memcpy(&lon, longitudes + i * sizeof(degrees), sizeof(degrees));
+        std::memcpy(&ele, elevations + i * sizeof(metres), sizeof(metres));
+        route->sourcePositions.push_back(Position(lat, lon, ele));
+    }
+    if (track) track->sourceTimes = reader.readVector<seconds>(numSource);
+
+    const std::vector<unsigned int> kept = reader.readVector<unsigned int>(counts.keptPoints);
+    // The first point is always kept, and the rest are in order.
+    if (kept.empty() || kept[0] != 0) PayloadReader::corrupt();
+    for (std::size_t i = 0; i < kept.size(); ++i)
+    {
+        if (kept[i] >= numSource || (i > 0 && kept[i] <= kept[i - 1])) PayloadReader::corrupt();
+    }
+
+    const std::vector<std::uint32_t> nameIndices = reader.readVector<std::uint32_t>(counts.sourceNames);
+    const std::vector<NameHandle> nameHandles = reader.readVector<NameHandle>(counts.sourceNames);
+    route->names.assign(reader.next<char>(counts.nameChars), counts.nameChars);
+    route->sourceNames.reserve(nameIndices.size());
+    for (std::size_t i = 0; i < nameIndices.size(); ++i)
+    {
+        const NameHandle & handle = nameHandles[i];
+        // Each named point appears once, in order.
+        if (nameIndices[i] >= numSource || (i > 0 && nameIndices[i] <= nameIndices[i - 1])
+            || (std::uint64_t)handle.offset + handle.length > counts.nameChars)
+        {
+            PayloadReader::corrupt();
+        }
+        route->sourceNames.push_back(std::make_pair(nameIndices[i], handle));
+    }
+
+    route->routeName.assign(reader.next<char>(counts.routeNameChars), counts.routeNameChars);
+    route->report.assign(reader.next<char>(counts.reportChars), counts.reportChars);
+
+    route->keepSourcePoints(kept);
+
+    route->segmentTable = reader.readVector<Segment>(kept.size() - 1);
+    if (route->storage == PositionStorage::Arrays)
+    {
+        route->positionArrays.assign(route->positions);
+    }
+
+    route->invalidateCaches();
+    route->cachedStatistics = counts.statistics;
+    route->statisticsCached = true;
+
+    return route;
+}
+
+std::unique_ptr<Track> RouteCache::loadTrack(const std::string & filePath, const std::string & sourceFile)
+{
+    std::unique_ptr<Route> route = loadRoute(filePath, sourceFile);
+    Track * track = dynamic_cast<Track *>(route.get());
+    if (! track)
+    {
+        throw std::domain_error("Cache file holds a Route, not a Track.");
+    }
+    route.release();
+    return std::unique_ptr<Track>(track);
+}
@@ -0,0 +1,52 @@
+#ifndef ROUTECACHE_H_211217
+#define ROUTECACHE_H_211217
+
+#include <string>
+#include <memory>
+#include <cstdint>
+
+#include "route.h"
+#include "track.h"
+
+namespace GPS
+{
+  /*  A binary snapshot of a constructed Route or Track, so it can be reloaded without parsing its GPX data.
+   *
+   *  The file holds everything the object was built from and everything it has computed: the
+   *  source points, times and names, which of them are kept at the current granularity, the
+   *  arrival and departure times, the segment table and the summary statistics.  Each of these
+   *  is a flat, 8-byte aligned array in the machine's native layout, so loading is a checked
+   *  memory map followed by a bulk copy of each array; nothing is parsed or recomputed.
+   *
+   *  A file written by a different format version or on a machine with a different byte order
+   *  is rejected, as is one whose checksum does not match its contents.
+   *
+   *  If the GPX file the object was read from is named when saving, its size and modification
+   *  time are recorded.  Naming it again when loading rejects the cache if the file has changed
+   *  since, so a stale cache is never used in place of the GPX data.
+   */
+  class RouteCache
+  {
+    public:
+      static const std::uint32_t formatVersion = 2;
+
+      /* Writes "route" (which may be a Track) to "filePath", replacing any existing file.
+       * If "sourceFile" is not empty, the size and modification time of that file are recorded.
+       * Throws a std::invalid_argument exception if either file cannot be accessed, or if "route" has no points.
+       */
+      static void save(const Route & route, const std::string & filePath, const std::string & sourceFile = "");
+
+      /* Loads a Route or Track saved by save(); the object is of the same type as the one saved.
+       * If "sourceFile" is not empty, the cache must have been saved from that file as it is now.
+       * Throws a std::invalid_argument exception if either file cannot be accessed, and a
+       * std::domain_error exception if the cache is not a valid cache file of this version or
+       * is out of date.
+       */
+      static std::unique_ptr<Route> loadRoute(const std::string & filePath, const std::string & sourceFile = "");
+
+      // As loadRoute(), but also throws a std::domain_error exception if the file holds a Route rather than a Track.
+      static std::unique_ptr<Track> loadTrack(const std::string & filePath, const std::string & sourceFile = "");
+  };
+}
+
+#endif
@@ -0,0 +1,66 @@
+#include <cmath>
+#include <algorithm>
+
+#include "earth.h"
+#include "positionarrays.h"
+#include "spatialindex.h"
+
+using namespace GPS;
+
+void SpatialIndex::build(const std::vector<Position> & positions, metres radius)
+{
+    clear();
+
+    /* Two points d metres apart are a straight-line distance of at most d apart, so cubes of side
+     * "radius" would suffice.  The cubes are made a little larger so that rounding in the unit
+     * vectors, or a slightly different Earth radius in Position::distanceBetween(), cannot matter.
+     */
+    cellSize = radius * 1.001 + 0.001;
+
+    std::vector<std::pair<Cell, unsigned int>> placed;
+    placed.reserve(positions.size());
+    for (unsigned int i = 0; i < positions.size(); ++i)
+    {
+        placed.push_back(std::make_pair(cellOf(positions[i]), i));
+    }
+    std::sort(placed.begin(), placed.end(),
+        [](const std::pair<Cell, unsigned int> & a, const std::pair<Cell, unsigned int> & b)
+        {
+            if (a.first.x != b.first.x) return a.first.x < b.first.x;
+            if (a.first.y != b.first.y) return a.first.y < b.first.y;
+            if (a.first.z != b.first.z) return a.first.z < b.first.z;
+            return a.second < b.second;
+        });
+
+    indices.resize(placed.size());
+    for (unsigned int i = 0; i < placed.size(); ++i)
+    {
+        indices[i] = placed[i].second;
+        if (i == 0 || ! (placed[i].first == placed[i - 1].first))
+        {
+            cells[placed[i].first] = std::make_pair(i, i);
+        }
+        ++cells[placed[i].first].second;
+    }
+    built = true;
+}
+
+void SpatialIndex::clear()
+{
+    built = false;
+    indices.clear();
+    cells.clear();
+}
+
+SpatialIndex::Cell SpatialIndex::cellOf(const Position & p) const
+{
+    degrees lat = p.latitude(), lon = p.longitude();
+    double x, y, z;
+    unitVectors(&lat, &lon, 1, &x, &y, &z);
+
+    const double scale = Earth::meanRadius / cellSize;
+    Cell cell = { (std::int64_t)std::floor(x * scale),
+                  (std::int64_t)std::floor(y * scale),
+                  (std::int64_t)std::floor(z * scale) };
+    return cell;
+}
@@ -0,0 +1,77 @@
+#ifndef SPATIALINDEX_H_211217
+#define SPATIALINDEX_H_211217
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <unordered_map>
+
+#include "types.h"
+#include "position.h"
+
+namespace GPS
+{
+  /*  A uniform grid over a set of Positions, for finding the points near a given location.
+   *
+   *  Each point is placed in a cube of side "radius" according to its position in space
+   *  (as a point on a sphere, so there is no special treatment of the poles or the 180th meridian).
+   *  Every point within "radius" (horizontally) of a location lies in the 27 cubes around it.
+   */
+  class SpatialIndex
+  {
+    public:
+      void build(const std::vector<Position> &, metres radius);
+      void clear();
+      bool isBuilt() const { return built; }
+
+      /*  Calls visit(i) for the index i of every point that may be within "radius" of "location",
+       *  including all that are.  The caller must still check the actual distance.
+       *  Within each cube the indices are visited in ascending order.
+       */
+      template <typename Visitor>
+      void forEachNear(const Position & location, Visitor visit) const;
+
+    private:
+      struct Cell
+      {
+          std::int64_t x, y, z;
+          bool operator==(const Cell & other) const { return x == other.x && y == other.y && z == other.z; }
+      };
+      struct CellHash
+      {
+          std::size_t operator()(const Cell & c) const
+          {
+              return (std::size_t)((std::uint64_t)c.x * 0x9E3779B97F4A7C15ull
+                                 ^ (std::uint64_t)c.y * 0xC2B2AE3D27D4EB4Full
+                                 ^ (std::uint64_t)c.z * 0x165667B19E3779F9ull);
+          }
+      };
+
+      Cell cellOf(const Position &) const;
+
+      bool built = false;
+      double cellSize = 0;
+      std::vector<unsigned int> indices; // Grouped by cell; ascending within each cell.
+      std::unordered_map<Cell, std::pair<unsigned int, unsigned int>, CellHash> cells; // [first, last) in "indices"
+  };
+
+  template <typename Visitor>
+  void SpatialIndex::forEachNear(const Position & location, Visitor visit) const
+  {
+      const Cell centre = cellOf(location);
+
+      for (std::int64_t dx = -1; dx <= 1; ++dx)
+      for (std::int64_t dy = -1; dy <= 1; ++dy)
+      for (std::int64_t dz = -1; dz <= 1; ++dz)
+      {
+          Cell neighbour = { centre.x + dx, centre.y + dy, centre.z + dz };
+          auto found = cells.find(neighbour);
+          if (found == cells.end()) continue;
+
+          for (unsigned int i = found->second.first; i < found->second.second; ++i) visit(indices[i]);
+      }
+  }
+}
+
+#endif
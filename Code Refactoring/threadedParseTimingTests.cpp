@@ -0,0 +1,83 @@
+/*  Scaling of Track parsing with the number of threads.
+ *
+ *  Times the construction of a 2M-point track with ParseOptions::threads set to 1, 2, 4, 8
+ *  and 16, and checks that each gives the same report as the single-threaded parse.
+ *  Only reading the track points is done in parallel; decimation remains serial.
+ */
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "track.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+namespace
+{
+    // A track heading North in steps of 0-20m, one point per second, with every hundredth point named.
+    std::string makeGPX(unsigned int numPoints)
+    {
+        std::vector<Position> points;
+        std::vector<seconds> times;
+        std::vector<std::string> names;
+        double lat = 52.0;
+        for (unsigned int i = 0; i < numPoints; ++i)
+        {
+            lat += (i % 7) * 0.00003;
+            points.push_back(Position(lat, -1.0, i % 100));
+            times.push_back(i);
+            names.push_back(i % 100 == 0 ? "P" + std::to_string(i) : "");
+        }
+        return GeneratedLogs::trackGPX(points, times, names);
+    }
+
+    template <typename Function>
+    double timeInMilliseconds(Function f)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto finish = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(finish - start).count();
+    }
+}
+
+int main()
+{
+    const unsigned int numPoints = 2000000;
+    const unsigned int threadCounts[] = { 1, 2, 4, 8, 16 };
+    const metres granularity = 10;
+    const std::string gpx = makeGPX(numPoints);
+
+    std::string serialReport;
+    double serialTime = 0;
+
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "parse (ms)" << std::setw(10) << "speedup" << std::endl;
+
+    for (unsigned int threads : threadCounts)
+    {
+        ParseOptions options;
+        options.threads = threads;
+
+        std::string report;
+        double parseTime = timeInMilliseconds([&]()
+        {
+            Track track(gpx, false, granularity, options);
+            report = track.buildReport();
+        });
+
+        if (threads == 1)
+        {
+            serialReport = report;
+            serialTime = parseTime;
+        }
+
+        std::cout << std::setw(8) << threads << std::setw(14) << parseTime
+                  << std::setw(10) << serialTime / parseTime;
+        if (report != serialReport) std::cout << "  MISMATCH with the single-threaded parse";
+        std::cout << std::endl;
+    }
+    return 0;
+}
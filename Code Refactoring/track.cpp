@@ -1,12 +1,15 @@
 #include <sstream>
-#include <fstream>
 #include <iostream>
 #include <cassert>
 #include <cmath>
 #include <stdexcept>
+#include <algorithm>
+#include <thread>
+#include <exception>
 
 #include "geometry.h"
-#include "xmlparser.h"
+#include "xmltokenizer.h"
+#include "parallelfor.h"
 #include "track.h"
 
 using namespace GPS;
@@ -22,13 +25,7 @@ seconds Track::totalTime() const
 
 seconds Track::restingTime() const
 {
-    seconds total = 0;
-    assert (arrived.size() == departed.size());
-    for (unsigned int i = 0; i < arrived.size(); ++i)
-    {
-        total += departed[i] - arrived[i];
-    }
-    return total;
+    return timing().restingTime;
 }
 
 seconds Track::travellingTime() const
@@ -38,19 +35,7 @@ seconds Track::travellingTime() const
 
 speed Track::maxSpeed() const
 {
-    assert( positions.size() == departed.size() && positions.size() == arrived.size() );
-    if (positions.size() == 1) return 0.0;
-
-    speed ms = 0;
-    for (unsigned int i = 1; i < positions.size(); ++i)
-    {
-        metres deltaH = Position::distanceBetween(positions[i],positions[i-1]);
-        metres deltaV = positions[i].elevation() - positions[i-1].elevation();
-        metres distance = std::sqrt(std::pow(deltaH,2) + std::pow(deltaV,2));
-        seconds time = arrived[i] - departed[i-1];
-        ms = std::max(ms,distance/time);
-    }
-    return ms;
+    return timing().maxSpeed;
 }
 
 speed Track::averageSpeed(bool includeRests) const
@@ -62,205 +47,347 @@ speed Track::averageSpeed(bool includeRests) const
 
 speed Track::maxRateOfAscent() const
 {
-    assert( positions.size() == departed.size() && positions.size() == arrived.size() );
-    if (positions.size() == 1) return 0.0;
-
-    speed ms = 0;
-    for (unsigned int i = 1; i < positions.size(); ++i)
-    {
-        metres height = positions[i].elevation() - positions[i-1].elevation();
-        seconds time = arrived[i] - departed[i-1];
-        ms = std::max(ms,height/time);
-    }
-    return ms;
+    return timing().maxRateOfAscent;
 }
 
 speed Track::maxRateOfDescent() const
 {
-    assert( positions.size() == departed.size() && positions.size() == arrived.size() );
-    if (positions.size() == 1) return 0.0;
+    return timing().maxRateOfDescent;
+}
 
-    speed ms = 0;
-    for (unsigned int i = 1; i < positions.size(); ++i)
-    {
-        metres height = positions[i-1].elevation() - positions[i].elevation();
-        seconds time = arrived[i] - departed[i-1];
-        ms = std::max(ms,height/time);
-    }
-    return ms;
+Track::Track(metres granularity, const ParseOptions & options)
+{
+    this->granularity = granularity;
+    this->reportGranularity = granularity;
+    this->storage = options.storage;
+    this->routeLength = 0;
 }
 
+void Track::append(const Position & position, seconds time)
+{
+    if (! sourceTimes.empty() && time < sourceTimes.back()) {
+        throw std::invalid_argument("Track point is earlier than the previous point.");
+    }
+    sourcePositions.push_back(position);
+    sourceTimes.push_back(time);
+    seconds timeElapsed = time - sourceTimes.front();
+
+    // As keepSourcePoints(): if we're still at the same location, then we haven't departed yet.
+    if (! positions.empty() && areSameLocation(position, positions.back())) {
+        if (timingCached) cachedTiming.restingTime += timeElapsed - departed.back();
+        departed.back() = timeElapsed;
+        return;
+    }
+
+    arrived.push_back(timeElapsed);
+    departed.push_back(timeElapsed);
+    appendPosition(position);
+
+    if (timingCached && positions.size() > 1) {
+        extendTiming(positions.size() - 1);
+    }
+}
 
-Track::Track(std::string source, bool isFileName, metres granularity)
+Track::Track(const std::string & source, bool isFileName, metres granularity, const ParseOptions & options)
 {
     using namespace std;
-    using namespace XML::Parser;
-
-    string mergedTrkSegs,trkseg,lat,lon,ele,time;
-    const int MAX = 3;
-    string tempStorage[MAX];
+    using namespace XML;
 
-    seconds startTime, currentTime, timeElapsed;
+    Element element;
     ostringstream reportStr;
 
-   // unsigned int num; not needed as number of posistion can be called using positionNames.size() vector
     this->granularity = granularity;
+    this->reportGranularity = granularity;
+    this->storage = options.storage;
 
+    MappedFile file;
+    TextView gpx(source);
     if (isFileName) {
-        std::string filePath = source;
-        Track::loadFileToSource(filePath, source); //file reading function obtained from route.h made public
+        Track::loadFileToSource(source, file); //file reading function obtained from route.h made public
+        gpx = file.view();
     }
 
-
-    if (! elementExists(source,"gpx")) {
+    if (! findElement(gpx, "gpx", element)) {
         throw domain_error("No 'gpx' element.");
-
-    } else {
-        tempStorage[0] = getElement(source, "gpx");
-        source = getElementContent( tempStorage[0]);
     }
-
-    if (! elementExists(source,"trk")) {
-        throw domain_error("No 'trtestk' element.");
-    } else {
-       tempStorage[0] = getElement(source, "trk");
-       source = getElementContent( tempStorage[0]);
+    if (! findElement(element.content, "trk", element)) {
+        throw domain_error("No 'trk' element.");
     }
-
-    if (elementExists(source, "name")) {
-        tempStorage[0] = getAndEraseElement(source, "name");
-        routeName = getElementContent( tempStorage[0]);
+    const TextView trkContent = element.content;
+
+    // Track points are read from every "trkseg" in turn, or straight from the "trk" if it has no segments.
+    Element trkseg;
+    const bool hasSegments = findElement(trkContent, "trkseg", trkseg);
+    Element trkpt;
+    const bool hasPoints = findElement(TextView(hasSegments ? trkseg.openingTag.first : trkContent.first,
+                                                trkContent.last), "trkpt", trkpt);
+
+    // The track name precedes the track segments and points.
+    TextView header(trkContent.first, hasSegments ? trkseg.openingTag.first
+                                                  : (hasPoints ? trkpt.openingTag.first : trkContent.last));
+    if (findElement(header, "name", element)) {
+        element.content.assignTo(routeName);
         reportStr << "Track name is: " << routeName << endl;
     }
 
-
-    while (elementExists(source, "trkseg")) {
-         tempStorage[0] = getAndEraseElement(source, "trkseg");
-        trkseg = getElementContent( tempStorage[0]);
-        getAndEraseElement(trkseg, "name");
-        mergedTrkSegs += trkseg;
+    if (! hasPoints) {
+        throw domain_error("No 'trkpt' element.");
     }
-    if (! mergedTrkSegs.empty()) {
-        source = mergedTrkSegs;
+
+    vector<TextView> regions;
+    if (hasSegments) {
+        Tokenizer segments(TextView(trkseg.openingTag.first, trkContent.last));
+        while (segments.next("trkseg", trkseg)) regions.push_back(trkseg.content);
+    } else {
+        regions.push_back(TextView(trkpt.openingTag.first, trkContent.last));
     }
 
-    if (! elementExists(source,"trkpt")) {
+    readPoints(regions, options.threads);
+    if (sourcePositions.empty()) { // Every "trkseg" is empty; any "trkpt" outside them is not read.
         throw domain_error("No 'trkpt' element.");
-    } else {
-     tempStorage[0] = getAndEraseElement(source, "trkpt");
     }
 
-    if (! attributeExists( tempStorage[0],"lat")) {
-        throw domain_error("No 'lat' attribute.");
-    } else {
-        lat = getElementAttribute( tempStorage[0], "lat");
+    report = reportStr.str(); // As before, the report does not include the line from opening the file.
+    decimate();
+
+    buildSegments();
+    Track::calcRouteLength();
+}
+
+namespace
+{
+    // The points read from part of the GPX data, with "names" indexed from the first of them.
+    struct TrackPoints
+    {
+        std::vector<Position> positions;
+        std::vector<seconds> times;
+        std::vector<std::pair<unsigned int, TextView>> names; // Views of the GPX data.
+    };
+
+    // Below this many bytes per thread, starting the threads costs more than it saves.
+    const std::size_t minBytesPerChunk = 64 * 1024;
+
+    /*  Divides "region" into about "numChunks" pieces, each starting at a "<trkpt" tag, so that
+     *  tokenizing the pieces separately finds exactly the same elements as tokenizing the whole.
+     */
+    void splitAtPoints(TextView region, std::size_t numChunks, std::vector<TextView> & chunks)
+    {
+        using namespace XML;
+
+        const char * chunkStart = region.first;
+        for (std::size_t c = 1; c < numChunks; ++c)
+        {
+            const char * target = region.first + region.size() * c / numChunks;
+            if (target <= chunkStart) continue;
+
+            Element next;
+            if (! findElement(TextView(target, region.last), "trkpt", next)) break;
+            if (next.openingTag.first == chunkStart) continue;
+
+            chunks.push_back(TextView(chunkStart, next.openingTag.first));
+            chunkStart = next.openingTag.first;
+        }
+        chunks.push_back(TextView(chunkStart, region.last));
     }
-    if (! attributeExists( tempStorage[0],"lon")) {
-        throw domain_error("No 'lon' attribute.");
+}
+
+void Track::readPoints(const std::vector<TextView> & regions, unsigned int numThreads)
+{
+    using namespace std;
+    using namespace XML;
+
+    if (numThreads == 0) numThreads = max(1u, thread::hardware_concurrency());
+
+    size_t totalSize = 0;
+    for (const TextView & region : regions) totalSize += region.size();
+    numThreads = (unsigned int)max<size_t>(1, min<size_t>(numThreads, totalSize / minBytesPerChunk));
+
+    vector<TextView> chunks;
+    if (numThreads == 1) {
+        chunks = regions;
     } else {
-        lon = getElementAttribute( tempStorage[0], "lon");
+        for (const TextView & region : regions) {
+            // Share the chunks between the regions in proportion to their size.
+            splitAtPoints(region, max<size_t>(1, region.size() * numThreads / totalSize), chunks);
+        }
     }
-    tempStorage[0] = getElementContent( tempStorage[0]);
-    if (elementExists( tempStorage[0], "ele")) {
-         tempStorage[1] = getElement( tempStorage[0], "ele");
-        ele = getElementContent( tempStorage[1]);
-        Position startPos = Position(lat,lon,ele);
-        positions.push_back(startPos);
-        reportStr << "Start position added: " << startPos.toString() << endl;
 
-    } else {
-        Position startPos = Position(lat,lon);
-        positions.push_back(startPos);
-        reportStr << "Start position added: " << startPos.toString() << endl;
+    vector<TrackPoints> points(chunks.size());
+    vector<exception_ptr> errors(chunks.size());
 
-    }
-    if (elementExists( tempStorage[0],"name")) {
-         tempStorage[1] = getElement( tempStorage[0],"name");
-        tempStorage[2] = getElementContent( tempStorage[1]);
-    } else {
-        positionNames.push_back(tempStorage[2]);
-        arrived.push_back(0);
-        departed.push_back(0);
+    auto readChunk = [&](size_t c)
+    {
+        Element trkpt, child;
+        TextView value;
+        string lat,lon,ele,time;
+        TrackPoints & out = points[c];
+
+        try {
+            Tokenizer tokenizer(chunks[c]);
+            while (tokenizer.next("trkpt", trkpt)) {
+                if (! findAttribute(trkpt, "lat", value)) {
+                    throw domain_error("No 'lat' attribute.");
+                }
+                value.assignTo(lat);
+                if (! findAttribute(trkpt, "lon", value)) {
+                    throw domain_error("No 'lon' attribute.");
+                }
+                value.assignTo(lon);
+
+                if (findElement(trkpt.content, "ele", child)) {
+                    child.content.assignTo(ele);
+                    out.positions.push_back(Position(lat,lon,ele));
+                } else {
+                    out.positions.push_back(Position(lat,lon));
+                }
+
+                if (! findElement(trkpt.content, "time", child)) {
+                    throw domain_error("No 'time' element.");
+                }
+                child.content.assignTo(time);
+                out.times.push_back(stringToTime(time));
+
+                if (findElement(trkpt.content, "name", child)) {
+                    out.names.push_back(make_pair((unsigned int)out.positions.size() - 1, child.content));
+                }
+            }
+        }
+        catch (...) {
+            errors[c] = current_exception();
+        }
+    };
+
+    parallelFor(chunks.size(), numThreads, readChunk);
+
+    // Report the error that a serial parse would have met first.
+    for (const exception_ptr & error : errors) {
+        if (error) rethrow_exception(error);
     }
 
-    if (! elementExists( tempStorage[0],"time")) {
-        throw domain_error("No 'time' element.");
-    } else {
-       tempStorage[1] = getElement( tempStorage[0],"time");
-       time = getElementContent( tempStorage[1]);
-       startTime = currentTime = stringToTime(time);
+    size_t numPoints = 0;
+    for (const TrackPoints & chunk : points) numPoints += chunk.positions.size();
+    sourcePositions.reserve(numPoints);
+    sourceTimes.reserve(numPoints);
+
+    for (TrackPoints & chunk : points) {
+        const unsigned int offset = (unsigned int)sourcePositions.size();
+        sourcePositions.insert(sourcePositions.end(), chunk.positions.begin(), chunk.positions.end());
+        sourceTimes.insert(sourceTimes.end(), chunk.times.begin(), chunk.times.end());
+        for (const auto & name : chunk.names) {
+            sourceNames.push_back(make_pair(offset + name.first, names.add(name.second)));
+        }
     }
+}
+
+void Track::keepSourcePoints(const std::vector<unsigned int> & kept)
+{
+    using namespace std;
 
-    Position prevPos = positions.back(), nextPos = positions.back();
-    while (elementExists(source, "trkpt")) {
-         tempStorage[0] = getAndEraseElement(source, "trkpt");
+    positions.clear();
+    positionNames.clear();
+    arrived.clear();
+    departed.clear();
+    positions.reserve(kept.size());
+    positionNames.reserve(kept.size());
+    arrived.reserve(kept.size());
+    departed.reserve(kept.size());
+    if (sourcePositions.empty()) return; // A live Track before its first append().
 
-        if (! attributeExists( tempStorage[0],"lat")) {
-            throw domain_error("No 'lat' attribute.");
+    auto nextKept = kept.begin();
+    auto nextName = sourceNames.begin();
+    const seconds startTime = sourceTimes.front();
 
-        } else {
-            lat = getElementAttribute( tempStorage[0], "lat");
+    for (unsigned int i = 0; i < sourcePositions.size(); ++i) {
+        seconds timeElapsed = sourceTimes[i] - startTime;
+
+        if (nextKept == kept.end() || *nextKept != i) {
+            // If we're still at the same location, then we haven't departed yet.
+            departed.back() = timeElapsed;
+            continue;
         }
+        ++nextKept;
 
-        if (! attributeExists( tempStorage[0],"lon")) {
-            throw domain_error("No 'lon' attribute.");
+        while (nextName != sourceNames.end() && nextName->first < i) ++nextName;
+        bool named = (nextName != sourceNames.end() && nextName->first == i);
 
-        } else {
-            lon = getElementAttribute( tempStorage[0], "lon");
-        }
+        positions.push_back(sourcePositions[i]);
+        positionNames.push_back(named ? nextName->second : NameHandle{ 0, 0 });
+        arrived.push_back(timeElapsed);
+        departed.push_back(timeElapsed);
+    }
+}
+
+void Track::reportDecimation(std::ostream & reportStr, const std::vector<unsigned int> & kept) const
+{
+    using namespace std;
 
-        tempStorage[0] = getElementContent( tempStorage[0]);
+    auto nextKept = kept.begin();
+    const seconds startTime = sourceTimes.empty() ? 0 : sourceTimes.front();
 
-        if (elementExists( tempStorage[0], "ele")) {
-             tempStorage[1] = getElement( tempStorage[0], "ele");
-            ele = getElementContent( tempStorage[1]);
-            nextPos = Position(lat,lon,ele);
+    for (unsigned int i = 0; i < sourcePositions.size(); ++i) {
+        const Position & nextPos = sourcePositions[i];
 
-        } else {
-            nextPos = Position(lat,lon);
+        if (nextKept == kept.end() || *nextKept != i) {
+            reportStr << "Position ignored: " << nextPos.toString() << endl;
+            continue;
         }
+        ++nextKept;
 
-        if (! elementExists( tempStorage[0],"time")) {
-            throw domain_error("No 'time' element.");
+        if (i == 0) {
+            reportStr << "Start position added: " << nextPos.toString() << endl;
         } else {
-            tempStorage[1] = getElement( tempStorage[0],"time");
-            time = getElementContent( tempStorage[1]);
-            currentTime = stringToTime(time);
+            reportStr << "Position added: " << nextPos.toString() << endl;
+            reportStr << " at time: " << to_string(sourceTimes[i] - startTime) << endl;
         }
+    }
+    reportStr << kept.size() << " positions added." << endl;
+}
 
+void Track::invalidateCaches()
+{
+    Route::invalidateCaches();
+    timingCached = false;
+}
 
-        if (areSameLocation(nextPos, prevPos)) {
-            // If we're still at the same location, then we haven't departed yet.
-            departed.back() = currentTime - startTime;
-            reportStr << "Position ignored: " << nextPos.toString() << endl;
-        } else {
-            if (elementExists( tempStorage[0],"name")) {
-                 tempStorage[1] = getElement( tempStorage[0],"name");
-                tempStorage[2] = getElementContent( tempStorage[1]);
-
-            } else {
-                tempStorage[2] = ""; // Fixed bug by adding this.
-                positions.push_back(nextPos);
-                positionNames.push_back(tempStorage[2]);
-                timeElapsed = currentTime - startTime;
-                arrived.push_back(timeElapsed);
-                departed.push_back(timeElapsed);
-                reportStr << "Position added: " << nextPos.toString() << endl;
-                reportStr << " at time: " << to_string(timeElapsed) << endl;
-                prevPos = nextPos;
-            }
+const Track::TimingStatistics & Track::timing() const
+{
+    if (! timingCached)
+    {
+        assert( positions.size() == departed.size() && positions.size() == arrived.size() );
+
+        cachedTiming.restingTime = 0;
+        for (unsigned int i = 0; i < arrived.size(); ++i)
+        {
+            cachedTiming.restingTime += departed[i] - arrived[i];
         }
+
+        cachedTiming.maxSpeed = 0;
+        cachedTiming.maxRateOfAscent = 0;
+        cachedTiming.maxRateOfDescent = 0;
+        for (unsigned int i = 1; i < positions.size(); ++i)
+        {
+            extendTiming(i);
+        }
+        timingCached = true;
     }
-    reportStr << positions.size() << " positions added." << endl;
+    return cachedTiming;
+}
 
-    Track::calcRouteLength();
-    report = reportStr.str();
+void Track::extendTiming(unsigned int i) const
+{
+    const Segment & segment = segmentTable[i-1];
+    metres distance = segment.length();
+    seconds time = arrived[i] - departed[i-1];
+
+    cachedTiming.maxSpeed = std::max(cachedTiming.maxSpeed, distance/time);
+    cachedTiming.maxRateOfAscent = std::max(cachedTiming.maxRateOfAscent, segment.deltaV/time);
+    cachedTiming.maxRateOfDescent = std::max(cachedTiming.maxRateOfDescent, -segment.deltaV/time);
 }
 
 void Track::setGranularity(metres granularity)
 {
-    bool implemented = false;
-    assert(implemented);
+    // keepSourcePoints() is virtual, so this also rebuilds the arrival and departure times.
+    Route::setGranularity(granularity);
 }
 
 seconds Track::stringToTime(const std::string & timeStr)
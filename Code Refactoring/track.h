@@ -16,9 +16,21 @@ namespace GPS
       /*  Tracks are constructed from GPX data.  The data can be provided as a string, or from a file.
        *  Any track points closer together than a certain minimum distance are discarded.
        */
-      Track(std::string source,
+      Track(const std::string & source,
             bool isFileName, // Is the first parameter a file name or a string containing GPX data?
-            metres granularity = 10); // The minimum distance between successive track points.
+            metres granularity = 10, // The minimum distance between successive track points.
+            const ParseOptions & options = ParseOptions());
+
+      /*  An empty Track, for a live feed whose points are added one at a time by append().
+       *  Points closer than "granularity" to the previous point kept are discarded, as for GPX data.
+       */
+      explicit Track(metres granularity, const ParseOptions & options = ParseOptions());
+
+      /* Adds a point to the end of the Track, as if it had been the next "trkpt" in the GPX data.
+       * The length, times, speeds and statistics are all updated in O(1).
+       * Throws a std::invalid_argument exception if "time" is before that of the previous point.
+       */
+      void append(const Position &, seconds time);
 
       /* Update the granularity of the stored Track.  Any position in the Track that differs in distance
        * from its predecessor by less than the updated granularity is discarded.
@@ -52,6 +64,11 @@ namespace GPS
       speed maxRateOfDescent() const;
 
     protected:
+      friend class RouteCache;
+      friend class CompressedTrack;
+
+      Track() {} // Only called by RouteCache.
+
       /* These vectors store the arrival time and departure time at each
        * Position in the Track.  These times are relative to the start of
        * the Track; thus arrived[0] is always 0.
@@ -59,9 +76,37 @@ namespace GPS
       std::vector<seconds> arrived;
       std::vector<seconds> departed;
 
+      // The time of each of the "sourcePositions", as read from the GPX data.
+      std::vector<seconds> sourceTimes;
+
+      void keepSourcePoints(const std::vector<unsigned int> & kept) override;
+      void reportDecimation(std::ostream & reportStr, const std::vector<unsigned int> & kept) const override;
+
+      /* Reads the "trkpt" elements in "regions" into the source points, in order.
+       * Large inputs are split at "trkpt" boundaries and read on up to "numThreads" threads.
+       */
+      void readPoints(const std::vector<TextView> & regions, unsigned int numThreads);
+
       static seconds stringToTime(const std::string &);
 
+      void invalidateCaches() override;
+
+    private:
+      // The results of the analytics that scan every point, computed on first use and extended by append().
+      struct TimingStatistics
+      {
+          seconds restingTime;
+          speed maxSpeed;
+          speed maxRateOfAscent;
+          speed maxRateOfDescent;
+      };
+      mutable TimingStatistics cachedTiming;
+      mutable bool timingCached = false;
+
+      const TimingStatistics & timing() const;
 
+      // Folds the segment ending at point "i" into the maximum speeds.
+      void extendTiming(unsigned int i) const;
   };
 }
 
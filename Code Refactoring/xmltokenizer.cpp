@@ -0,0 +1,145 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "xmltokenizer.h"
+
+namespace XML
+{
+    namespace
+    {
+        bool isNameTerminator(char c)
+        {
+            return c == '>' || c == '/' || c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        }
+
+        // Does an element name start at "pos", followed by the end of the tag name?
+        bool nameMatches(const char * pos, const char * last, const char * name, std::size_t nameLength)
+        {
+            return (std::size_t)(last - pos) > nameLength
+                && std::memcmp(pos, name, nameLength) == 0
+                && isNameTerminator(pos[nameLength]);
+        }
+
+        const char * findChar(const char * first, const char * last, char c)
+        {
+            const void * found = std::memchr(first, c, (std::size_t)(last - first));
+            return found ? static_cast<const char *>(found) : last;
+        }
+
+        // Finds the '>' that ends the tag starting at "first", skipping quoted attribute values.
+        const char * findTagEnd(const char * first, const char * last)
+        {
+            for (const char * pos = first; pos != last; ++pos)
+            {
+                if (*pos == '>') return pos;
+                if (*pos == '"' || *pos == '\'')
+                {
+                    pos = findChar(pos + 1, last, *pos);
+                    if (pos == last) break;
+                }
+            }
+            return last;
+        }
+
+        // Finds the "</name>" tag closing an element whose content starts at "first".
+        const char * findClosingTag(const char * first, const char * last, const char * name, std::size_t nameLength)
+        {
+            for (const char * pos = findChar(first, last, '<'); pos != last; pos = findChar(pos + 1, last, '<'))
+            {
+                if (pos + 1 != last && pos[1] == '/' && nameMatches(pos + 2, last, name, nameLength))
+                {
+                    return pos;
+                }
+            }
+            return last;
+        }
+    }
+
+    bool findElement(GPS::TextView source, const char * elementName, Element & element)
+    {
+        const std::size_t nameLength = std::strlen(elementName);
+        const char * last = source.last;
+
+        for (const char * pos = findChar(source.first, last, '<'); pos != last; pos = findChar(pos + 1, last, '<'))
+        {
+            if (! nameMatches(pos + 1, last, elementName, nameLength)) continue;
+
+            const char * tagEnd = findTagEnd(pos + 1 + nameLength, last);
+            if (tagEnd == last)
+            {
+                throw std::domain_error("Unterminated '" + std::string(elementName) + "' tag.");
+            }
+            element.openingTag = GPS::TextView(pos, tagEnd + 1);
+
+            if (*(tagEnd - 1) == '/') // <name ... />
+            {
+                element.content = GPS::TextView(tagEnd + 1, tagEnd + 1);
+                element.end = tagEnd + 1;
+                return true;
+            }
+
+            const char * closingTag = findClosingTag(tagEnd + 1, last, elementName, nameLength);
+            const char * closingEnd = findChar(closingTag, last, '>');
+            if (closingEnd == last)
+            {
+                throw std::domain_error("No closing tag for '" + std::string(elementName) + "' element.");
+            }
+            element.content = GPS::TextView(tagEnd + 1, closingTag);
+            element.end = closingEnd + 1;
+            return true;
+        }
+        return false;
+    }
+
+    bool findAttribute(const Element & element, const char * attributeName, GPS::TextView & value)
+    {
+        const std::size_t nameLength = std::strlen(attributeName);
+        const char * first = element.openingTag.first;
+        const char * last = element.openingTag.last;
+
+        // Skip "<elementName" so that only attributes are examined.
+        const char * pos = first + 1;
+        while (pos != last && ! isNameTerminator(*pos)) ++pos;
+
+        while (pos != last)
+        {
+            while (pos != last && (*pos == ' ' || *pos == '\t' || *pos == '\r' || *pos == '\n')) ++pos;
+            const char * nameStart = pos;
+            while (pos != last && *pos != '=' && *pos != '>' && *pos != '/' && *pos != ' ') ++pos;
+            const char * nameEnd = pos;
+            while (pos != last && *pos == ' ') ++pos;
+            if (pos == last || *pos != '=')
+            {
+                if (pos != last) ++pos;
+                continue;
+            }
+            ++pos;
+            while (pos != last && *pos == ' ') ++pos;
+            if (pos == last || (*pos != '"' && *pos != '\'')) return false;
+
+            const char * valueStart = pos + 1;
+            const char * valueEnd = findChar(valueStart, last, *pos);
+            if (valueEnd == last) return false;
+
+            if ((std::size_t)(nameEnd - nameStart) == nameLength
+                && std::memcmp(nameStart, attributeName, nameLength) == 0)
+            {
+                value = GPS::TextView(valueStart, valueEnd);
+                return true;
+            }
+            pos = valueEnd + 1;
+        }
+        return false;
+    }
+
+    bool Tokenizer::next(const char * elementName, Element & element)
+    {
+        if (! findElement(GPS::TextView(cursor, last), elementName, element))
+        {
+            cursor = last;
+            return false;
+        }
+        cursor = element.end;
+        return true;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef XMLTOKENIZER_H_211217
+#define XMLTOKENIZER_H_211217
+
+#include <string>
+#include <cstddef>
+
+#include "textview.h"
+
+namespace XML
+{
+  // The location of an element within a source buffer.
+  struct Element
+  {
+      GPS::TextView openingTag; // From the '<' to the '>' of the opening tag.
+      GPS::TextView content;    // Everything between the opening and closing tags; empty for "<name/>".
+      const char * end;    // One past the '>' of the closing tag.
+  };
+
+  /*  Finds the first element called "elementName" that starts inside "source".
+   *  Returns false if there is no such element.
+   *  Throws a std::domain_error if the element is not closed.
+   */
+  bool findElement(GPS::TextView source, const char * elementName, Element & element);
+
+  // Returns true if the opening tag of "element" has the named attribute, and stores its value.
+  bool findAttribute(const Element & element, const char * attributeName, GPS::TextView & value);
+
+  /*  A forward-only cursor over the elements of a source buffer.
+   *  Each call to next() continues from the end of the previously returned element,
+   *  so walking every element of a buffer visits each character once.
+   *  The buffer is never modified or copied.
+   */
+  class Tokenizer
+  {
+    public:
+      explicit Tokenizer(GPS::TextView source) : cursor(source.first), last(source.last) {}
+
+      // Advances to the next element called "elementName"; returns false when none remain.
+      bool next(const char * elementName, Element & element);
+
+      // The part of the source buffer that has not been consumed yet.
+      GPS::TextView remaining() const { return GPS::TextView(cursor, last); }
+
+    private:
+      const char * cursor;
+      const char * last;
+  };
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef PARALLELFOR_H_211217
+#define PARALLELFOR_H_211217
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <exception>
+#include <algorithm>
+
+/*  Calls body(i) for every i in [0, count), on up to "numThreads" threads (0 means one per hardware
+ *  thread) including the calling thread, and returns when every call has finished.
+ *
+ *  Each thread claims the next unclaimed index from a shared counter, so a thread that draws a few
+ *  slow items does not hold up the rest: the others simply claim more of the quick ones.  Calls for
+ *  different indices may run concurrently, in any order; the body must make them independent.
+ *
+ *  If a call throws, no further indices are claimed, and the first exception thrown is rethrown
+ *  once every thread has stopped.
+ */
+template <typename Body>
+void parallelFor(std::size_t count, unsigned int numThreads, Body body)
+{
+    if (numThreads == 0) numThreads = std::thread::hardware_concurrency();
+    numThreads = (unsigned int)std::max<std::size_t>(1, std::min<std::size_t>(numThreads, count));
+
+    if (numThreads == 1)
+    {
+        for (std::size_t i = 0; i < count; ++i) body(i);
+        return;
+    }
+
+    std::atomic<std::size_t> nextIndex(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr firstError;
+
+    auto worker = [&]()
+    {
+        try
+        {
+            for (std::size_t i = nextIndex++; i < count && ! failed; i = nextIndex++) body(i);
+        }
+        catch (...)
+        {
+            if (! failed.exchange(true)) firstError = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+    for (unsigned int t = 1; t < numThreads; ++t) threads.emplace_back(worker);
+    worker();
+    for (std::thread & thread : threads) thread.join();
+
+    if (firstError) std::rethrow_exception(firstError);
+}
+
+#endif
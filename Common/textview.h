@@ -0,0 +1,31 @@
+#ifndef TEXTVIEW_H_211217
+#define TEXTVIEW_H_211217
+
+#include <string>
+#include <cstddef>
+
+namespace GPS
+{
+  /*  A read-only view of a range of characters inside a source buffer, such as GPX or NMEA data.
+   *  The view does not own the characters; the buffer must outlive it.
+   */
+  struct TextView
+  {
+      const char * first;
+      const char * last;
+
+      TextView() : first(nullptr), last(nullptr) {}
+      TextView(const char * first, const char * last) : first(first), last(last) {}
+      explicit TextView(const std::string & source)
+        : first(source.data()), last(source.data() + source.size()) {}
+
+      bool empty() const { return first == last; }
+      std::size_t size() const { return static_cast<std::size_t>(last - first); }
+
+      // Copies the viewed characters into "target", reusing its storage.
+      void assignTo(std::string & target) const { target.assign(first, last); }
+      std::string str() const { return std::string(first, last); }
+  };
+}
+
+#endif
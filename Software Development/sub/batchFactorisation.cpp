@@ -0,0 +1,159 @@
+#include <algorithm>
+
+#include "parallelfor.h"
+#include "factorisationEngine.h"
+#include "batchFactorisation.h"
+
+typedef unsigned long long int u64;
+
+namespace
+{
+    const std::size_t sieveSegment = 32768; // Numbers sieved at a time; small enough to stay in the L1 cache.
+    const std::size_t inputsPerBlock = 1024; // Inputs claimed by a thread at a time.
+
+    u64 inverseOf(u64 odd)
+    {
+        u64 inverse = odd; // Correct to 3 bits; each Newton step doubles that.
+        for (int i = 0; i < 5; ++i) inverse *= 2 - odd * inverse;
+        return inverse;
+    }
+
+    // The factors found for one block of inputs, and how many belong to each input.
+    struct BlockResult
+    {
+        std::vector<u64> factors;
+        std::vector<unsigned char> counts;
+    };
+}
+
+PrimeTable::PrimeTable(unsigned int limit)
+{
+    // The primes up to sqrt(limit), by a plain sieve, cross off the composites in each segment.
+    unsigned int root = 1;
+    while ((u64)(root + 1) * (root + 1) < limit) ++root;
+    std::vector<bool> smallComposite(root + 1, false);
+    std::vector<unsigned int> sievingPrimes;
+    for (unsigned int p = 2; p <= root; ++p)
+    {
+        if (smallComposite[p]) continue;
+        sievingPrimes.push_back(p);
+        for (unsigned int m = p * p; m <= root; m += p) smallComposite[m] = true;
+    }
+
+    std::vector<char> composite(sieveSegment);
+    for (u64 low = 2; low < limit; low += sieveSegment)
+    {
+        const u64 high = std::min<u64>(low + sieveSegment, limit);
+        std::fill(composite.begin(), composite.end(), 0);
+        for (unsigned int p : sievingPrimes)
+        {
+            u64 start = std::max<u64>((u64)p * p, (low + p - 1) / p * p);
+            for (u64 m = start; m < high; m += p) composite[m - low] = 1;
+        }
+        for (u64 n = low; n < high; ++n)
+        {
+            if (composite[n - low]) continue;
+            Divisor divisor = { n, 0, 0 };
+            if (n % 2 == 1)
+            {
+                divisor.inverse = inverseOf(n);
+                divisor.maxQuotient = ~0ULL / n;
+            }
+            divisors.push_back(divisor);
+        }
+    }
+}
+
+const PrimeTable & sharedPrimeTable()
+{
+    static const PrimeTable table(1 << 12);
+    return table;
+}
+
+unsigned int factoriseInto(unsigned long long int x, const PrimeTable & primes, unsigned long long int * factors)
+{
+    unsigned int count = 0;
+    if (x <= 1) return 0;
+
+    while (x % 2 == 0)
+    {
+        factors[count++] = 2;
+        x /= 2;
+    }
+
+    std::size_t i = 1;
+    for (; i < primes.size() && primes.prime(i) * primes.prime(i) <= x; ++i)
+    {
+        while (primes.divides(i, x))
+        {
+            factors[count++] = primes.prime(i);
+            x = primes.exactQuotient(i, x);
+        }
+    }
+
+    if (x == 1) return count;
+    if (i < primes.size())
+    {
+        factors[count++] = x; // Trial division got past sqrt(x), so x is prime.
+        return count;
+    }
+
+    // x has no factors in the table; those found are all larger than any so far, so sorting them keeps the order.
+    unsigned int numLarge = factoriseLarge(x, factors + count);
+    std::sort(factors + count, factors + count + numLarge);
+    return count + numLarge;
+}
+
+FactorBatch primeFactorisationBatch(const unsigned long long int * inputs, std::size_t count, unsigned int numThreads)
+{
+    const PrimeTable & primes = sharedPrimeTable();
+    const std::size_t numBlocks = (count + inputsPerBlock - 1) / inputsPerBlock;
+
+    std::vector<BlockResult> blocks(numBlocks);
+    parallelFor(numBlocks, numThreads, [&](std::size_t b)
+    {
+        u64 found[maxPrimeFactors];
+        BlockResult & block = blocks[b];
+        const std::size_t first = b * inputsPerBlock, last = std::min(first + inputsPerBlock, count);
+        block.counts.reserve(last - first);
+        block.factors.reserve((last - first) * 4);
+        for (std::size_t i = first; i < last; ++i)
+        {
+            unsigned int numFound = factoriseInto(inputs[i], primes, found);
+            block.counts.push_back((unsigned char)numFound);
+            block.factors.insert(block.factors.end(), found, found + numFound);
+        }
+    });
+
+    // Where each block's factors go.
+    std::vector<std::size_t> blockStarts(numBlocks + 1, 0);
+    for (std::size_t b = 0; b < numBlocks; ++b)
+    {
+        blockStarts[b + 1] = blockStarts[b] + blocks[b].factors.size();
+    }
+
+    FactorBatch batch;
+    batch.factors.resize(blockStarts.back());
+    batch.offsets.resize(count + 1);
+    batch.offsets[0] = 0;
+
+    parallelFor(numBlocks, numThreads, [&](std::size_t b)
+    {
+        BlockResult & block = blocks[b];
+        std::copy(block.factors.begin(), block.factors.end(), batch.factors.begin() + blockStarts[b]);
+        std::size_t offset = blockStarts[b];
+        for (std::size_t i = 0; i < block.counts.size(); ++i)
+        {
+            offset += block.counts[i];
+            batch.offsets[b * inputsPerBlock + i + 1] = offset;
+        }
+        block = BlockResult();
+    });
+
+    return batch;
+}
+
+FactorBatch primeFactorisationBatch(const std::vector<unsigned long long int> & inputs, unsigned int numThreads)
+{
+    return primeFactorisationBatch(inputs.data(), inputs.size(), numThreads);
+}
@@ -0,0 +1,70 @@
+#ifndef BATCHFACTORISATION_H
+#define BATCHFACTORISATION_H
+
+#include <vector>
+#include <cstddef>
+
+/* The primes below a limit, found with a segmented sieve, each stored with what is needed to test
+ * divisibility by it with one multiplication instead of a division: for odd p, x is a multiple of p
+ * exactly when x * p^-1 (mod 2^64) <= (2^64 - 1) / p. */
+class PrimeTable
+{
+  public:
+    explicit PrimeTable(unsigned int limit);
+
+    std::size_t size() const { return divisors.size(); }
+
+    unsigned long long int prime(std::size_t i) const { return divisors[i].prime; }
+
+    // Is x a multiple of prime(i)? Only for i > 0: prime(0) is 2, which has no inverse, so test x % 2 instead.
+    bool divides(std::size_t i, unsigned long long int x) const
+    {
+        return x * divisors[i].inverse <= divisors[i].maxQuotient;
+    }
+
+    // x / prime(i), for x known to be a multiple of it.
+    unsigned long long int exactQuotient(std::size_t i, unsigned long long int x) const
+    {
+        return x * divisors[i].inverse;
+    }
+
+  private:
+    struct Divisor
+    {
+        unsigned long long int prime;
+        unsigned long long int inverse; // prime^-1 mod 2^64
+        unsigned long long int maxQuotient; // (2^64 - 1) / prime
+    };
+
+    std::vector<Divisor> divisors;
+};
+
+/* The primes below 2^12, built once, on first use. Trial division by larger primes costs more than
+ * Pollard's rho takes to find such factors (measured on random 32 to 64-bit inputs). */
+const PrimeTable & sharedPrimeTable();
+
+/* Writes the prime factors of x, in ascending order, to "factors" (which must have room for
+ * maxPrimeFactors) and returns how many there are; none for x <= 1, as for primeFactorisation().
+ * Trial division by "primes" finds the small factors; factoriseLarge() finds any left. */
+unsigned int factoriseInto(unsigned long long int x, const PrimeTable & primes, unsigned long long int * factors);
+
+// The prime factors of many numbers: those of input i are factors[offsets[i]] up to factors[offsets[i + 1]].
+struct FactorBatch
+{
+    std::vector<unsigned long long int> factors;
+    std::vector<std::size_t> offsets;
+
+    std::size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+    std::size_t numFactors(std::size_t i) const { return offsets[i + 1] - offsets[i]; }
+    const unsigned long long int * begin(std::size_t i) const { return factors.data() + offsets[i]; }
+    const unsigned long long int * end(std::size_t i) const { return factors.data() + offsets[i + 1]; }
+};
+
+/* Factorises "count" numbers from "inputs" on "numThreads" threads (0 for one per core). Each thread
+ * claims blocks of inputs in turn and writes their factors to a buffer of its own; once every count is
+ * known, the buffers are copied into place in parallel. No lists are allocated. */
+FactorBatch primeFactorisationBatch(const unsigned long long int * inputs, std::size_t count, unsigned int numThreads = 0);
+
+FactorBatch primeFactorisationBatch(const std::vector<unsigned long long int> & inputs, unsigned int numThreads = 0);
+
+#endif
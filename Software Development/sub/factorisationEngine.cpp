@@ -0,0 +1,238 @@
+#include <algorithm>
+
+#include "factorisationEngine.h"
+
+typedef unsigned long long int u64;
+
+namespace
+{
+    // The 128-bit product of two 64-bit numbers, as its high and low halves.
+    struct Product
+    {
+        u64 high;
+        u64 low;
+    };
+
+    Product multiply(u64 a, u64 b)
+    {
+#if defined(__SIZEOF_INT128__)
+        unsigned __int128 p = (unsigned __int128)a * b;
+        return Product{ (u64)(p >> 64), (u64)p };
+#else
+        // Schoolbook multiplication of 32-bit halves.
+        u64 aLow = a & 0xFFFFFFFF, aHigh = a >> 32;
+        u64 bLow = b & 0xFFFFFFFF, bHigh = b >> 32;
+        u64 lowLow = aLow * bLow;
+        u64 middle1 = aHigh * bLow + (lowLow >> 32);
+        u64 middle2 = aLow * bHigh + (middle1 & 0xFFFFFFFF);
+        return Product{ aHigh * bHigh + (middle1 >> 32) + (middle2 >> 32), (middle2 << 32) | (lowLow & 0xFFFFFFFF) };
+#endif
+    }
+
+    unsigned int trailingZeros(u64 x)
+    {
+#if defined(__GNUC__)
+        return (unsigned int)__builtin_ctzll(x);
+#else
+        unsigned int count = 0;
+        while (! (x & 1)) { x >>= 1; ++count; }
+        return count;
+#endif
+    }
+
+    // Binary (Stein's) GCD; faster than Euclid's as it needs no division.
+    u64 gcd(u64 a, u64 b)
+    {
+        if (a == 0) return b;
+        if (b == 0) return a;
+        unsigned int shift = trailingZeros(a | b);
+        a >>= trailingZeros(a);
+        while (b != 0)
+        {
+            b >>= trailingZeros(b);
+            if (a > b) std::swap(a, b);
+            b -= a;
+        }
+        return a << shift;
+    }
+
+    /* Arithmetic modulo an odd n in Montgomery form, where x is held as x*2^64 mod n. A product is
+     * reduced by adding the multiple of n that clears its low 64 bits, then keeping the high 64 bits. */
+    class Montgomery
+    {
+      public:
+        explicit Montgomery(u64 n) : n(n)
+        {
+            // Newton's iteration for n^-1 mod 2^64; each step doubles the number of correct bits (n*n = 1 mod 8 to start).
+            inverse = n;
+            for (int i = 0; i < 5; ++i) inverse *= 2 - n * inverse;
+
+            u64 r = (0 - n) % n; // 2^64 mod n
+            rSquared = reduceFull(multiply(r, r));
+            one = r;
+        }
+
+        u64 modulus() const { return n; }
+
+        u64 toForm(u64 x) const { return mul(x % n, rSquared); }
+
+        u64 mul(u64 a, u64 b) const { return reduce(multiply(a, b)); }
+
+        u64 add(u64 a, u64 b) const { return (a >= n - b) ? a - (n - b) : a + b; }
+
+        u64 sub(u64 a, u64 b) const { return (a >= b) ? a - b : a + (n - b); }
+
+        u64 power(u64 base, u64 exponent) const
+        {
+            u64 result = one;
+            for (; exponent != 0; exponent >>= 1)
+            {
+                if (exponent & 1) result = mul(result, base);
+                base = mul(base, base);
+            }
+            return result;
+        }
+
+        u64 unity() const { return one; }
+
+      private:
+        u64 n;
+        u64 inverse; // n^-1 mod 2^64
+        u64 rSquared; // 2^128 mod n
+        u64 one; // 1 in Montgomery form
+
+        u64 reduce(Product t) const
+        {
+            u64 m = t.low * inverse;
+            u64 mnHigh = multiply(m, n).high; // The low halves of t and m*n are equal, so only the high halves are subtracted.
+            return (t.high >= mnHigh) ? t.high - mnHigh : t.high + (n - mnHigh);
+        }
+
+        // (high*2^64 + low) mod n, for setting up rSquared without Montgomery form.
+        u64 reduceFull(Product t) const
+        {
+            u64 remainder = t.high % n;
+            for (int bit = 63; bit >= 0; --bit)
+            {
+                bool carry = remainder >> 63;
+                remainder = (remainder << 1) | ((t.low >> bit) & 1);
+                if (carry || remainder >= n) remainder -= n;
+            }
+            return remainder;
+        }
+    };
+
+    // One round of Miller-Rabin: is n a strong probable prime to base "witness"? n - 1 = d * 2^s with d odd.
+    bool isStrongProbablePrime(const Montgomery & mont, u64 witness, u64 d, unsigned int s)
+    {
+        const u64 n = mont.modulus();
+        if (witness % n == 0) return true;
+
+        const u64 minusOne = mont.sub(0, mont.unity());
+        u64 x = mont.power(mont.toForm(witness), d);
+        if (x == mont.unity() || x == minusOne) return true;
+        for (unsigned int i = 1; i < s; ++i)
+        {
+            x = mont.mul(x, x);
+            if (x == minusOne) return true;
+        }
+        return false;
+    }
+}
+
+bool isPrime(unsigned long long int n)
+{
+    if (n < 2) return false;
+    const u64 smallPrimes[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+    for (u64 p : smallPrimes)
+    {
+        if (n % p == 0) return n == p;
+    }
+    if (n < 37 * 37) return true;
+
+    u64 d = n - 1;
+    unsigned int s = trailingZeros(d);
+    d >>= s;
+
+    // These seven bases are enough to make the test exact for every n < 2^64 (Jim Sinclair, 2011).
+    const u64 witnesses[] = { 2, 325, 9375, 28178, 450775, 9780504, 1795265022 };
+    Montgomery mont(n);
+    for (u64 witness : witnesses)
+    {
+        if (! isStrongProbablePrime(mont, witness, d, s)) return false;
+    }
+    return true;
+}
+
+unsigned long long int findFactor(unsigned long long int n)
+{
+    /* Brent's cycle finding on the sequence y -> y^2 + c mod n. Differences between the sequence at
+     * powers of two and later terms are multiplied together in batches of "batchSize" so that only
+     * one gcd is needed per batch; if a batch overshoots to a gcd of n, its steps are retried one by one. */
+    const u64 batchSize = 128;
+    const Montgomery mont(n);
+
+    for (u64 c = 1; ; ++c)
+    {
+        const u64 increment = mont.toForm(c);
+        auto next = [&](u64 y) { return mont.add(mont.mul(y, y), increment); };
+
+        u64 y = mont.toForm(2), x = y, saved = y;
+        u64 product = mont.unity();
+        u64 factor = 1;
+
+        for (u64 range = 1; factor == 1; range *= 2)
+        {
+            x = y;
+            for (u64 i = 0; i < range; ++i) y = next(y);
+
+            for (u64 done = 0; done < range && factor == 1; done += batchSize)
+            {
+                saved = y;
+                const u64 steps = std::min(batchSize, range - done);
+                for (u64 i = 0; i < steps; ++i)
+                {
+                    y = next(y);
+                    product = mont.mul(product, mont.sub(x, y));
+                }
+                factor = gcd(product, n);
+            }
+        }
+
+        if (factor == n)
+        {
+            do
+            {
+                saved = next(saved);
+                factor = gcd(mont.sub(x, saved), n);
+            } while (factor == 1);
+        }
+        if (factor != n) return factor;
+        // Otherwise the cycle closed without separating the factors, so try another sequence.
+    }
+}
+
+unsigned int factoriseLarge(unsigned long long int n, unsigned long long int * factors)
+{
+    if (n == 1) return 0;
+    if (isPrime(n))
+    {
+        factors[0] = n;
+        return 1;
+    }
+    if (n % 2 == 0)
+    {
+        factors[0] = 2;
+        return 1 + factoriseLarge(n / 2, factors + 1);
+    }
+    u64 factor = findFactor(n);
+    unsigned int count = factoriseLarge(factor, factors);
+    return count + factoriseLarge(n / factor, factors + count);
+}
+
+void factoriseLarge(unsigned long long int n, std::list<unsigned long long int> & factors)
+{
+    u64 found[maxPrimeFactors];
+    unsigned int count = factoriseLarge(n, found);
+    factors.insert(factors.end(), found, found + count);
+}
@@ -0,0 +1,25 @@
+#ifndef FACTORISATIONENGINE_H
+#define FACTORISATIONENGINE_H
+
+#include <list>
+
+/* Factorisation of 64-bit numbers that have no small factors, for use once trial division
+ * stops being cheap. Arithmetic modulo n is done in Montgomery form with 128-bit products,
+ * so no step needs a division. */
+
+// Deterministic Miller-Rabin test; exact for every 64-bit number.
+bool isPrime(unsigned long long int n);
+
+// Returns a non-trivial factor (not necessarily prime) of an odd composite n > 1, using Brent's variant of Pollard's rho.
+unsigned long long int findFactor(unsigned long long int n);
+
+// A 64-bit number has at most 64 prime factors.
+const unsigned int maxPrimeFactors = 64;
+
+// Writes the prime factors of n > 1 to "factors", in no particular order, and returns how many there are.
+unsigned int factoriseLarge(unsigned long long int n, unsigned long long int * factors);
+
+// Appends the prime factors of n > 1 to "factors", in no particular order.
+void factoriseLarge(unsigned long long int n, std::list<unsigned long long int> & factors);
+
+#endif
@@ -1,35 +1,59 @@
-#include <math.h>
+#include <algorithm>
 
 #include "primeFactorisation.h"
+#include "primeFactors.h"
+#include "factorisationEngine.h"
+#include "spfCache.h"
+#include "wheel.h"
 
-std::list<unsigned long long int> primeFactorisation(unsigned long long int x)
+const unsigned long long int wheelModulus = 210; // 2*3*5*7
+
+void primeFactorisation(unsigned long long int x, PrimeFactors & primeF)
 {   
-    //assign wheel
-    long wheel[] = {1,2,2,4,2,4,2,4,6,2,6};// each number is the jump between the next prime number. 
-    long  fFactor= 2; // The first possible factor.
-    int tcount = 0; // spoke
-    
-    std::list<unsigned long long int> primeF;
+    const long trialLimit = 1000; // Past this, factors are found by factoriseLarge() rather than by trial division.
+    primeF.clear();
+
+    const SPFCache * cache = activeSPFCache();
+    if (cache && cache->covers(x)) // Look the factors up instead, if useSPFCache() has been given a table that covers x.
+    {
+        cache->factorise(x, primeF);
+        return;
+    }
     
-    if(x <= 1) // Checks if the x is smaler or equal than 1, if true returns list as is.
+    if(x <= 1) // Checks if the x is smaler or equal than 1, if true returns with no factors.
         
     {
-        return primeF;
+        return;
+    }
+
+    // The jumps between trial divisors come from a wheel generated at compile time (see wheel.h).
+    unsigned long long int fFactor = wheelTrialDivision<wheelModulus>(x, primeF, trialLimit);
+    if ( fFactor <= trialLimit) // Trial division got past the square root of x, so x is prime.
+    {
+        primeF.push(x);
+        return;
     }
-    while ( fFactor <= sqrt(x)) // check if the prime number is less than or equal to the square root of x.
+
+    // x has no factors below trialLimit; finish with Miller-Rabin and Pollard's rho, in order.
+    unsigned long long int largeF[maxPrimeFactors];
+    unsigned int numLarge = factoriseLarge(x, largeF);
+    std::sort(largeF, largeF + numLarge);
+    for (unsigned int i = 0; i < numLarge; ++i)
+    {
+        primeF.push(largeF[i]);
+    }
+}
+
+std::list<unsigned long long int> primeFactorisation(unsigned long long int x)
+{
+    PrimeFactors factors;
+    primeFactorisation(x, factors);
+
+    std::list<unsigned long long int> primeF;
+    for (const PrimeFactors::PrimePower & power : factors)
     {
-        if (x % fFactor == 0) // if the remander of x  equals to 0 then that means it's a prime factor and the number is put to the list and then divid it by the prime number.
-        { 
-            primeF.push_back(fFactor); 
-            x /= fFactor; 
-        } 
-        else 
-        {
-            fFactor += wheel[tcount]; // the fFactor takes the value of the next prime factor.
-            tcount = (tcount == 10) ? 3 : (tcount+1); // Insted of using an if statement I used condition '?' result_if_true (resets the 'tcount' to value 3) and ':' result_if_false (adds 1 to 'tcount'
-        }
+        primeF.insert(primeF.end(), power.exponent, power.prime);
     }
-    primeF.push_back(x);
     return primeF;
 }
 
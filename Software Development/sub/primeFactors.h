@@ -0,0 +1,53 @@
+#ifndef PRIMEFACTORS_H
+#define PRIMEFACTORS_H
+
+/* The prime factorisation of a 64-bit number as (prime, exponent) pairs in ascending order of prime,
+ * held inline so that it needs no heap allocation. A 64-bit number has at most 15 distinct prime
+ * factors, as the product of the first 16 primes is more than 2^64. */
+class PrimeFactors
+{
+  public:
+    struct PrimePower
+    {
+        unsigned long long int prime;
+        unsigned int exponent;
+    };
+
+    static constexpr unsigned int maxDistinct = 15;
+
+    constexpr PrimeFactors() : powers(), count(0) {}
+
+    // The number of distinct primes.
+    constexpr unsigned int size() const { return count; }
+    constexpr bool empty() const { return count == 0; }
+
+    constexpr const PrimePower & operator[](unsigned int i) const { return powers[i]; }
+    constexpr const PrimePower * begin() const { return powers; }
+    constexpr const PrimePower * end() const { return powers + count; }
+
+    // The number of prime factors counted with multiplicity, as in the list from primeFactorisation().
+    constexpr unsigned int numFactors() const
+    {
+        unsigned int total = 0;
+        for (unsigned int i = 0; i < count; ++i) total += powers[i].exponent;
+        return total;
+    }
+
+    constexpr void clear() { count = 0; }
+
+    // Adds a prime no smaller than any already added.
+    constexpr void push(unsigned long long int prime)
+    {
+        if (count > 0 && powers[count - 1].prime == prime) ++powers[count - 1].exponent;
+        else powers[count++] = PrimePower{ prime, 1 };
+    }
+
+  private:
+    PrimePower powers[maxDistinct];
+    unsigned int count;
+};
+
+// As primeFactorisation(x), but writing into "factors" instead of allocating a list.
+void primeFactorisation(unsigned long long int x, PrimeFactors & factors);
+
+#endif
@@ -0,0 +1,207 @@
+#include <atomic>
+#include <fstream>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SPF_HAS_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "parallelfor.h"
+#include "spfCache.h"
+
+typedef unsigned long long int u64;
+
+namespace
+{
+    const std::size_t segmentEntries = 16384; // 32KB of entries, to stay in the L1 cache while sieving.
+
+    const char fileMagic[8] = { 'S', 'P', 'F', 'C', 'A', 'C', 'H', 'E' };
+    const std::uint32_t fileVersion = 1;
+
+    struct FileHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t entryBytes; // Also detects a file written with the other byte order.
+        std::uint64_t bound;
+        std::uint64_t numEntries;
+    };
+
+    u64 entriesFor(u64 bound)
+    {
+        return bound / 2; // The odd numbers below bound.
+    }
+
+    std::atomic<const SPFCache *> activeCache(nullptr);
+}
+
+SPFCache::SPFCache(unsigned long long int bound, unsigned int numThreads)
+  : limit(bound), entries(nullptr), mapping(nullptr), mappingSize(0)
+{
+    if (bound > maxBound)
+    {
+        throw std::invalid_argument("SPF cache bound is above 2^32.");
+    }
+    const u64 numEntries = entriesFor(bound);
+    built.assign(numEntries, 0);
+    entries = built.data();
+
+    // The odd primes up to sqrt(bound), by a plain sieve.
+    u64 root = 1;
+    while ((root + 1) * (root + 1) < bound) ++root;
+    std::vector<bool> composite(root + 1, false);
+    std::vector<std::uint32_t> primes;
+    for (u64 p = 3; p <= root; p += 2)
+    {
+        if (composite[p]) continue;
+        primes.push_back((std::uint32_t)p);
+        for (u64 m = p * p; m <= root; m += 2 * p) composite[m] = true;
+    }
+
+    /* Each segment is the entries for a run of odd numbers. Its multiples of each prime, from p^2,
+     * are marked with p unless already marked; as the primes go in ascending order, the first mark
+     * is the smallest factor. Segments are independent, so threads share them out with parallelFor(). */
+    const u64 numSegments = (numEntries + segmentEntries - 1) / segmentEntries;
+    std::uint16_t * table = built.data();
+    parallelFor(numSegments, numThreads, [&](std::size_t s)
+    {
+        const u64 firstEntry = s * segmentEntries;
+        const u64 lastEntry = std::min(firstEntry + segmentEntries, numEntries);
+        const u64 low = 2 * firstEntry + 1, high = 2 * lastEntry + 1; // The odd numbers in [low, high).
+        for (std::uint32_t p : primes)
+        {
+            const u64 square = (u64)p * p;
+            if (square >= high) break;
+            u64 m = std::max(square, (low + p - 1) / p * p);
+            if (m % 2 == 0) m += p;
+            for (; m < high; m += 2 * p)
+            {
+                if (table[m / 2] == 0) table[m / 2] = (std::uint16_t)p;
+            }
+        }
+    });
+}
+
+SPFCache::SPFCache(const std::string & filePath)
+  : limit(0), entries(nullptr), mapping(nullptr), mappingSize(0)
+{
+    std::ifstream file(filePath, std::ios::binary);
+    FileHeader header;
+    if (! file.read(reinterpret_cast<char *>(&header), sizeof(header)))
+    {
+        if (! file.is_open()) throw std::invalid_argument("Error opening SPF cache file '" + filePath + "'.");
+        throw std::domain_error("Not an SPF cache file.");
+    }
+    if (std::memcmp(header.magic, fileMagic, sizeof(fileMagic)) != 0 || header.version != fileVersion
+        || header.entryBytes != sizeof(std::uint16_t) || header.bound > maxBound
+        || header.numEntries != entriesFor(header.bound))
+    {
+        throw std::domain_error("Not an SPF cache file.");
+    }
+    file.seekg(0, std::ios::end);
+    const u64 fileSize = (u64)file.tellg();
+    const u64 expectedSize = sizeof(header) + header.numEntries * sizeof(std::uint16_t);
+    if (fileSize != expectedSize)
+    {
+        throw std::domain_error("SPF cache file is corrupt.");
+    }
+    limit = header.bound;
+
+#ifdef SPF_HAS_MMAP
+    int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        void * address = ::mmap(nullptr, expectedSize, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (address != MAP_FAILED)
+        {
+            ::madvise(address, expectedSize, MADV_RANDOM); // Lookups jump about the table.
+            mapping = address;
+            mappingSize = expectedSize;
+            entries = reinterpret_cast<const std::uint16_t *>(static_cast<const char *>(address) + sizeof(header));
+            return;
+        }
+    }
+#endif
+
+    // No mapping available: read the table once instead.
+    built.resize(header.numEntries);
+    file.seekg(sizeof(header));
+    if (! file.read(reinterpret_cast<char *>(built.data()), header.numEntries * sizeof(std::uint16_t)))
+    {
+        throw std::domain_error("SPF cache file is corrupt.");
+    }
+    entries = built.data();
+}
+
+SPFCache::~SPFCache()
+{
+#ifdef SPF_HAS_MMAP
+    if (mapping) ::munmap(mapping, mappingSize);
+#endif
+}
+
+void SPFCache::save(const std::string & filePath) const
+{
+    FileHeader header;
+    std::memcpy(header.magic, fileMagic, sizeof(fileMagic));
+    header.version = fileVersion;
+    header.entryBytes = sizeof(std::uint16_t);
+    header.bound = limit;
+    header.numEntries = entriesFor(limit);
+
+    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(entries), (std::streamsize)(header.numEntries * sizeof(std::uint16_t)));
+    file.close();
+    if (! file)
+    {
+        throw std::invalid_argument("Error writing SPF cache file '" + filePath + "'.");
+    }
+}
+
+unsigned long long int SPFCache::smallestFactor(unsigned long long int x) const
+{
+    if (x % 2 == 0) return 2;
+    const std::uint16_t factor = entries[x / 2];
+    return factor ? factor : x;
+}
+
+void SPFCache::factorise(unsigned long long int x, PrimeFactors & factors) const
+{
+    factors.clear();
+    if (x <= 1) return;
+
+    while (x % 2 == 0)
+    {
+        factors.push(2);
+        x /= 2;
+    }
+    while (x > 1)
+    {
+        const std::uint16_t factor = entries[x / 2];
+        if (factor == 0)
+        {
+            factors.push(x);
+            return;
+        }
+        factors.push(factor);
+        x /= factor;
+    }
+}
+
+void useSPFCache(const SPFCache * cache)
+{
+    activeCache.store(cache, std::memory_order_release);
+}
+
+const SPFCache * activeSPFCache()
+{
+    return activeCache.load(std::memory_order_acquire);
+}
@@ -0,0 +1,59 @@
+#ifndef SPFCACHE_H
+#define SPFCACHE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "primeFactors.h"
+
+/* The smallest prime factor of every odd number below a bound, so that such a number is factorised by
+ * O(log n) table lookups. Only odd numbers are stored, each in 16 bits (0 for primes), which is enough
+ * for a bound of up to 2^32 and takes one byte per number in the range: 100MB for 10^8.
+ *
+ * The table is built with a segmented sieve, one L1-cache-sized segment at a time, with the segments
+ * shared between threads. It can be saved to a file and later memory-mapped rather than rebuilt. */
+class SPFCache
+{
+  public:
+    static constexpr unsigned long long int maxBound = 1ULL << 32;
+
+    // Builds the table for numbers below "bound" on "numThreads" threads (0 for one per core).
+    // Throws a std::invalid_argument exception if bound > maxBound.
+    explicit SPFCache(unsigned long long int bound, unsigned int numThreads = 1);
+
+    // Maps a table written by save(); the file must not change while it is in use.
+    // Throws a std::invalid_argument exception if it cannot be read, or std::domain_error if it is not an SPF cache file.
+    explicit SPFCache(const std::string & filePath);
+
+    ~SPFCache();
+
+    void save(const std::string & filePath) const;
+
+    unsigned long long int bound() const { return limit; }
+    bool covers(unsigned long long int x) const { return x < limit; }
+
+    // The smallest prime factor of 1 < x < bound().
+    unsigned long long int smallestFactor(unsigned long long int x) const;
+
+    // As primeFactorisation(x, factors), for x < bound().
+    void factorise(unsigned long long int x, PrimeFactors & factors) const;
+
+  private:
+    SPFCache(const SPFCache &) = delete;
+    SPFCache & operator=(const SPFCache &) = delete;
+
+    unsigned long long int limit;
+    const std::uint16_t * entries; // entries[n / 2] for odd n; into "built" or a mapped file.
+    std::vector<std::uint16_t> built;
+    void * mapping;
+    std::size_t mappingSize;
+};
+
+/* Makes primeFactorisation() look up numbers below cache->bound() in "cache" instead of trial-dividing
+ * them, or stops it doing so if "cache" is null. The cache must outlive its use. */
+void useSPFCache(const SPFCache * cache);
+
+const SPFCache * activeSPFCache();
+
+#endif
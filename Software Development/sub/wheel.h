@@ -0,0 +1,146 @@
+#ifndef WHEEL_H
+#define WHEEL_H
+
+#include "primeFactors.h"
+
+/* Wheels for trial division, generated at compile time. A wheel for a primorial modulus (2, 6, 30,
+ * 210, 2310, 30030) lists the gaps from 2 through the primes dividing the modulus (its basis) and on
+ * to each number coprime to the modulus in turn; after the basis the gaps repeat every modulus, so
+ * a trial divisor steps through the gaps and goes back to the first after the basis at the end. */
+
+constexpr bool isSmallPrime(unsigned long long int n)
+{
+    if (n < 2) return false;
+    for (unsigned long long int d = 2; d * d <= n; ++d)
+    {
+        if (n % d == 0) return false;
+    }
+    return true;
+}
+
+constexpr unsigned long long int commonFactor(unsigned long long int a, unsigned long long int b)
+{
+    while (b != 0)
+    {
+        unsigned long long int r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+// Is n the product of the first k primes, for some k > 0?
+constexpr bool isPrimorial(unsigned long long int n)
+{
+    for (unsigned long long int p = 2; n > 1; ++p)
+    {
+        if (! isSmallPrime(p)) continue;
+        if (n % p != 0) return false;
+        n /= p;
+        if (n % p == 0) return false;
+    }
+    return n == 1;
+}
+
+template <unsigned long long int Modulus>
+class Wheel
+{
+    static_assert(isPrimorial(Modulus) && Modulus <= 30030, "A wheel's modulus must be one of 2, 6, 30, 210, 2310 or 30030.");
+
+    static constexpr unsigned int countBasis()
+    {
+        unsigned int count = 0;
+        for (unsigned long long int p = 2; p <= Modulus; ++p)
+        {
+            if (Modulus % p == 0 && isSmallPrime(p)) ++count;
+        }
+        return count;
+    }
+
+    static constexpr unsigned int countSpokes()
+    {
+        unsigned int count = 0;
+        for (unsigned long long int n = 1; n <= Modulus; ++n)
+        {
+            if (commonFactor(n, Modulus) == 1) ++count;
+        }
+        return count;
+    }
+
+  public:
+    static constexpr unsigned int numBasis = countBasis();
+    static constexpr unsigned int numSpokes = countSpokes(); // Euler's totient of the modulus.
+    static constexpr unsigned int size = numBasis + numSpokes;
+    static constexpr unsigned int restart = numBasis; // Where the gaps start repeating.
+
+    constexpr Wheel() : increments()
+    {
+        unsigned long long int candidate = 2;
+        unsigned int i = 0;
+        for (unsigned long long int n = 3; i < size; ++n)
+        {
+            bool isBasis = Modulus % n == 0 && isSmallPrime(n);
+            if (isBasis || commonFactor(n, Modulus) == 1)
+            {
+                increments[i++] = (unsigned char)(n - candidate);
+                candidate = n;
+            }
+        }
+    }
+
+    // The gap from trial divisor number "spoke" to the next.
+    constexpr unsigned int operator[](unsigned int spoke) const { return increments[spoke]; }
+
+    constexpr unsigned int next(unsigned int spoke) const { return (spoke + 1 == size) ? restart : spoke + 1; }
+
+  private:
+    unsigned char increments[size]; // The gaps are at most 22 for every supported modulus.
+};
+
+template <unsigned long long int Modulus>
+inline constexpr Wheel<Modulus> wheelOf{};
+
+/* Divides out of x, onto "factors", each prime factor up to "limit" that trial division with the
+ * wheel finds before the trial divisor passes sqrt(x). A factor is only divided out while its square
+ * is at most x, so an x greater than 1 stays greater than 1: its largest prime factor is never
+ * divided out. Returns the next trial divisor: if that is no more than "limit", it has passed the
+ * square root of what is left of x, so (for x > 1) x is now prime. Otherwise x has no prime factor
+ * below "limit", but may be composite. */
+template <unsigned long long int Modulus>
+constexpr unsigned long long int wheelTrialDivision(unsigned long long int & x, PrimeFactors & factors,
+                                                    unsigned long long int limit)
+{
+    const Wheel<Modulus> & wheel = wheelOf<Modulus>;
+    unsigned long long int factor = 2;
+    unsigned int spoke = 0;
+    while (factor <= limit && factor <= 0xFFFFFFFF && factor * factor <= x) // The square of a larger factor would overflow, and exceed x.
+    {
+        if (x % factor == 0)
+        {
+            factors.push(factor);
+            x /= factor;
+        }
+        else
+        {
+            factor += wheel[spoke];
+            spoke = wheel.next(spoke);
+        }
+    }
+    return factor;
+}
+
+/* The factorisation of x by trial division alone, for compile-time constants, e.g.
+ *     static_assert(constexprFactorisation(360)[0].exponent == 3, "360 = 2^3 * 3^2 * 5");
+ * Each trial divisor is a step of constant evaluation, so compilers' step limits restrict this to
+ * numbers whose second-largest prime factor is at most a few million. */
+template <unsigned long long int WheelModulus = 210>
+constexpr PrimeFactors constexprFactorisation(unsigned long long int x)
+{
+    PrimeFactors factors;
+    if (x <= 1) return factors;
+    wheelTrialDivision<WheelModulus>(x, factors, ~0ULL);
+    if (x > 1) factors.push(x);
+    return factors;
+}
+
+#endif
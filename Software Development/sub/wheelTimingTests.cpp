@@ -0,0 +1,53 @@
+/* Trial division with wheels of increasing size, all generated at compile time.
+ *
+ * Times factorising the same 20000 random numbers below 2^36 by trial division alone with the
+ * 30, 210, 2310 and 30030 wheels; each should find the same factors. The static_asserts check
+ * constexprFactorisation() while compiling. */
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+#include "wheel.h"
+
+static_assert(Wheel<30>::size == 11 && Wheel<210>::size == 52 && Wheel<30030>::numSpokes == 5760, "Wheel sizes");
+static_assert(constexprFactorisation(1).empty(), "1 has no prime factors");
+static_assert(constexprFactorisation(360).size() == 3 && constexprFactorisation(360)[0].exponent == 3, "360 = 2^3 * 3^2 * 5");
+static_assert(constexprFactorisation<30030>(1000000007ULL * 999983).numFactors() == 2, "A product of two primes");
+
+namespace
+{
+    template <unsigned long long int Modulus>
+    void timeWheel(const std::vector<unsigned long long int> & inputs)
+    {
+        unsigned long long int total = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned long long int x : inputs)
+        {
+            PrimeFactors factors;
+            wheelTrialDivision<Modulus>(x, factors, ~0ULL);
+            if (x > 1) factors.push(x);
+            total += factors.numFactors();
+        }
+        auto finish = std::chrono::steady_clock::now();
+        std::cout << std::setw(10) << Modulus << std::setw(10) << Wheel<Modulus>::numSpokes
+                  << std::setw(12) << std::chrono::duration<double, std::milli>(finish - start).count()
+                  << std::setw(12) << total << std::endl;
+    }
+}
+
+int main()
+{
+    std::mt19937_64 random(1);
+    std::vector<unsigned long long int> inputs(20000);
+    for (unsigned long long int & x : inputs) x = random() >> 28;
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::setw(10) << "modulus" << std::setw(10) << "spokes" << std::setw(12) << "ms" << std::setw(12) << "factors" << std::endl;
+    timeWheel<30>(inputs);
+    timeWheel<210>(inputs);
+    timeWheel<2310>(inputs);
+    timeWheel<30030>(inputs);
+    return 0;
+}
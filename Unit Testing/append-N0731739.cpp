@@ -0,0 +1,120 @@
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+
+#include "types.h"
+#include "track.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+BOOST_AUTO_TEST_SUITE( Track_append_N0731739 )
+
+const bool isFileName = true;
+
+ParseOptions withStorage(PositionStorage storage)
+{
+    ParseOptions options;
+    options.storage = storage;
+    return options;
+}
+
+const PositionStorage storages[] = { PositionStorage::Objects, PositionStorage::Arrays };
+
+// A walk that stops for a while every so often, so that some points are rests.
+struct StoppingWalk
+{
+    std::vector<Position> points;
+    std::vector<seconds> times;
+
+    explicit StoppingWalk(unsigned int numPoints)
+    {
+        const std::vector<Position> walk = GeneratedLogs::randomWalk(numPoints, 31);
+        seconds time = 1000;
+        for (unsigned int i = 0; i < numPoints; ++i)
+        {
+            points.push_back(i % 25 < 3 && i > 0 ? points.back() : walk[i]);
+            times.push_back(time);
+            time += 3 + i % 4;
+        }
+    }
+
+    std::string gpx(unsigned int numPoints) const
+    {
+        return GeneratedLogs::trackGPX(std::vector<Position>(points.begin(), points.begin() + numPoints),
+                                       std::vector<seconds>(times.begin(), times.begin() + numPoints));
+    }
+};
+
+void checkSameTrack(const Track & live, const Track & parsed)
+{
+    BOOST_REQUIRE_EQUAL( live.numPositions(), parsed.numPositions() );
+    for (unsigned int i = 0; i < parsed.numPositions(); ++i)
+    {
+        BOOST_CHECK_EQUAL( live[i].latitude(), parsed[i].latitude() );
+        BOOST_CHECK_EQUAL( live[i].longitude(), parsed[i].longitude() );
+        BOOST_CHECK_EQUAL( live[i].elevation(), parsed[i].elevation() );
+    }
+    BOOST_CHECK_CLOSE( live.totalLength(), parsed.totalLength(), 1e-9 );
+    BOOST_CHECK_EQUAL( live.totalTime(), parsed.totalTime() );
+    BOOST_CHECK_EQUAL( live.restingTime(), parsed.restingTime() );
+    BOOST_CHECK_EQUAL( live.travellingTime(), parsed.travellingTime() );
+    BOOST_CHECK_EQUAL( live.maxSpeed(), parsed.maxSpeed() );
+    BOOST_CHECK_EQUAL( live.maxRateOfAscent(), parsed.maxRateOfAscent() );
+    BOOST_CHECK_EQUAL( live.maxRateOfDescent(), parsed.maxRateOfDescent() );
+    BOOST_CHECK_EQUAL( live.maxGradient(), parsed.maxGradient() );
+}
+
+// Appending the points one by one gives the same Track as parsing them, with either storage.
+BOOST_AUTO_TEST_CASE( SameAsParsed )
+{
+    const StoppingWalk walk(600);
+    for (PositionStorage storage : storages)
+    {
+        Track live(10, withStorage(storage));
+        for (unsigned int i = 0; i < walk.points.size(); ++i) live.append(walk.points[i], walk.times[i]);
+
+        const Track parsed(walk.gpx(walk.points.size()), ! isFileName, 10, withStorage(storage));
+        checkSameTrack(live, parsed);
+        // A live Track has no name to report.
+        BOOST_CHECK_EQUAL( "Track name is: Generated\n" + live.buildReport(), parsed.buildReport() );
+    }
+}
+
+// The getters are current after every append(), including those answered from cached timings.
+BOOST_AUTO_TEST_CASE( CurrentAfterEachAppend )
+{
+    const StoppingWalk walk(120);
+    for (PositionStorage storage : storages)
+    {
+        Track live(10, withStorage(storage));
+        for (unsigned int i = 0; i < walk.points.size(); ++i)
+        {
+            live.append(walk.points[i], walk.times[i]);
+            if (i % 7 == 6) checkSameTrack(live, Track(walk.gpx(i + 1), ! isFileName, 10, withStorage(storage)));
+        }
+    }
+}
+
+// Changing the granularity of a live Track re-decimates all the points appended.
+BOOST_AUTO_TEST_CASE( SetGranularity )
+{
+    const StoppingWalk walk(300);
+    Track live(10);
+    for (unsigned int i = 0; i < walk.points.size(); ++i) live.append(walk.points[i], walk.times[i]);
+    live.setGranularity(30);
+
+    checkSameTrack(live, Track(walk.gpx(walk.points.size()), ! isFileName, 30));
+}
+
+BOOST_AUTO_TEST_CASE( EarlierPoint )
+{
+    Track live(10);
+    live.append(Position(52.9, -1.18, 40), 100);
+    BOOST_CHECK_THROW( live.append(Position(52.91, -1.18, 40), 99), std::invalid_argument );
+    BOOST_CHECK_EQUAL( live.numPositions(), 1 );
+    BOOST_CHECK_NO_THROW( live.append(Position(52.91, -1.18, 40), 100) );
+    BOOST_CHECK_EQUAL( live.numPositions(), 2 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,104 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <fstream>
+#include <exception>
+
+#include "logs.h"
+#include "batchloader.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+BOOST_AUTO_TEST_SUITE( BatchLoader_N0731739 )
+
+const bool isFileName = true;
+const unsigned int numFiles = 12;
+
+std::string writeLogFile(const std::string & fileName, const std::string & contents)
+{
+    const std::string filePath = LogFiles::LogsDir + fileName;
+    std::ofstream file(filePath);
+    file << contents;
+    file.close();
+    return filePath;
+}
+
+// Files of different sizes, so that each result can be matched to its file.
+std::vector<std::string> routeFiles()
+{
+    std::vector<std::string> filePaths;
+    for (unsigned int i = 0; i < numFiles; ++i)
+    {
+        const std::vector<Position> points = GeneratedLogs::randomWalk(50 + 150 * ((i * 7) % numFiles), 30 + i);
+        filePaths.push_back(writeLogFile("batchLoader_N0731739_" + std::to_string(i) + ".gpx", GeneratedLogs::routeGPX(points)));
+    }
+    return filePaths;
+}
+
+// What the constructor itself throws for "filePath".
+std::string constructorError(const std::string & filePath)
+{
+    try
+    {
+        Route route(filePath, isFileName);
+    }
+    catch (const std::exception & e)
+    {
+        return e.what();
+    }
+    return "";
+}
+
+// However many threads share the files, each result is the one for the file at the same position.
+BOOST_AUTO_TEST_CASE( InputOrderOnAnyNumberOfThreads )
+{
+    const std::vector<std::string> filePaths = routeFiles();
+
+    for (unsigned int threads : { 0, 1, 2, 5, 32 })
+    {
+        const std::vector<LoadedRoute> results = loadRoutes(filePaths, 20, ParseOptions(), threads);
+        BOOST_REQUIRE_EQUAL( results.size(), filePaths.size() );
+        for (unsigned int i = 0; i < filePaths.size(); ++i)
+        {
+            const Route expected(filePaths[i], isFileName, 20);
+            BOOST_CHECK_EQUAL( results[i].path, filePaths[i] );
+            BOOST_REQUIRE( results[i].succeeded() );
+            BOOST_CHECK( results[i].error.empty() );
+            BOOST_CHECK_EQUAL( results[i].value->numPositions(), expected.numPositions() );
+            BOOST_CHECK_EQUAL( results[i].value->totalLength(), expected.totalLength() );
+        }
+    }
+
+    const std::vector<LoadedTrack> none = loadTracks({}, 10, ParseOptions(), 4);
+    BOOST_CHECK( none.empty() );
+}
+
+// A file that cannot be loaded gets the constructor's error in its own result; the others still load.
+BOOST_AUTO_TEST_CASE( BadFileDoesNotStopBatch )
+{
+    std::vector<std::string> filePaths = routeFiles();
+    const std::string missing = LogFiles::LogsDir + "batchLoader_N0731739_missing.gpx";
+    const std::string malformed = writeLogFile("batchLoader_N0731739_malformed.gpx", "<gpx><rte><rtept lat=\"52.9\"></rtept></rte></gpx>");
+    filePaths.insert(filePaths.begin() + 3, missing);
+    filePaths.push_back(malformed);
+
+    for (unsigned int threads : { 1, 4 })
+    {
+        const std::vector<LoadedRoute> results = loadRoutes(filePaths, 20, ParseOptions(), threads);
+        BOOST_REQUIRE_EQUAL( results.size(), filePaths.size() );
+        for (unsigned int i = 0; i < filePaths.size(); ++i)
+        {
+            BOOST_CHECK_EQUAL( results[i].path, filePaths[i] );
+            const std::string error = constructorError(filePaths[i]);
+            BOOST_CHECK_EQUAL( results[i].succeeded(), error.empty() );
+            BOOST_CHECK_EQUAL( results[i].error, error );
+        }
+        BOOST_CHECK( ! results[3].succeeded() );
+        BOOST_CHECK( ! results.back().succeeded() );
+        BOOST_CHECK( ! results[3].error.empty() );
+        BOOST_CHECK( ! results.back().error.empty() );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,70 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+
+#include "logs.h"
+#include "types.h"
+#include "route.h"
+#include "track.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+BOOST_AUTO_TEST_SUITE( Route_buildReport_N0731739 )
+
+const bool isFileName = true;
+
+// Three points about 111m apart, with the middle one only 5m from the first.
+const std::vector<Position> points = { Position(0, 0, 10), Position(0, 0.000045, 12), Position(0, 0.001, 15) };
+const std::vector<seconds> times = { 100, 130, 190 };
+
+std::string writeLogFile(const std::string & filePath, const std::string & contents)
+{
+    std::ofstream file(filePath);
+    file << contents;
+    file.close();
+    return filePath;
+}
+
+// A Track read from a file reports its name and points, but not the opening of the file.
+BOOST_AUTO_TEST_CASE( TrackFromFile )
+{
+    const std::string filePath = writeLogFile(LogFiles::GPXTracksDir + "buildReport_N0731739.gpx",
+                                              GeneratedLogs::trackGPX(points, times));
+    Track track(filePath, isFileName, 20);
+
+    const std::string expected = "Track name is: Generated\n"
+                                 "Start position added: " + points[0].toString() + "\n"
+                                 "Position ignored: " + points[1].toString() + "\n"
+                                 "Position added: " + points[2].toString() + "\n"
+                                 " at time: 90\n"
+                                 "2 positions added.\n";
+    BOOST_CHECK_EQUAL( track.buildReport(), expected );
+}
+
+// A Track read from a string reports the same as one read from a file.
+BOOST_AUTO_TEST_CASE( TrackFromString )
+{
+    const std::string gpx = GeneratedLogs::trackGPX(points, times);
+    const std::string filePath = writeLogFile(LogFiles::GPXTracksDir + "buildReport_N0731739.gpx", gpx);
+
+    BOOST_CHECK_EQUAL( Track(gpx, ! isFileName, 20).buildReport(), Track(filePath, isFileName, 20).buildReport() );
+}
+
+// A Route read from a file does report the opening of the file.
+BOOST_AUTO_TEST_CASE( RouteFromFile )
+{
+    const std::string filePath = writeLogFile(LogFiles::GPXRoutesDir + "buildReport_N0731739.gpx",
+                                              GeneratedLogs::routeGPX(points));
+    Route route(filePath, isFileName, 20);
+
+    const std::string expected = "Source file '" + filePath + "' opened okay.\n"
+                                 "Route name is: Generated\n"
+                                 "Position added: " + points[0].toString() + "\n"
+                                 "Position ignored: " + points[1].toString() + "\n"
+                                 "Position added: " + points[2].toString() + "\n"
+                                 "2 positions added.\n";
+    BOOST_CHECK_EQUAL( route.buildReport(), expected );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
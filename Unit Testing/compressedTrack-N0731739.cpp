@@ -0,0 +1,92 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <stdexcept>
+
+#include "types.h"
+#include "track.h"
+#include "compressedtrack.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+BOOST_AUTO_TEST_SUITE( CompressedTrack_N0731739 )
+
+const bool isFileName = true;
+
+// A walk with a rest at every tenth point, long enough to span several blocks.
+Track restingWalk(unsigned int numPoints)
+{
+    std::vector<Position> points = GeneratedLogs::randomWalk(numPoints, 21);
+    std::vector<seconds> times;
+    seconds time = 0;
+    for (unsigned int i = 0; i < numPoints; ++i)
+    {
+        if (i % 10 == 0 && i > 0)
+        {
+            points.insert(points.begin() + i, points[i - 1]);
+            points.pop_back();
+        }
+        times.push_back(time);
+        time += 4 + i % 3;
+    }
+    return Track(GeneratedLogs::trackGPX(points, times), ! isFileName, 5);
+}
+
+BOOST_AUTO_TEST_CASE( EmptyTrack )
+{
+    const Track empty(10);
+    BOOST_CHECK_THROW( CompressedTrack compressed(empty), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( SinglePoint )
+{
+    const Track track = restingWalk(1);
+    const CompressedTrack compressed(track);
+
+    BOOST_REQUIRE_EQUAL( compressed.numPositions(), 1 );
+    BOOST_CHECK_EQUAL( compressed.totalTime(), 0 );
+    BOOST_CHECK_EQUAL( compressed.maxSpeed(), 0 );
+    BOOST_CHECK_THROW( compressed[1], std::out_of_range );
+}
+
+// Each point is within the quantisation of the original, and the times are exact.
+BOOST_AUTO_TEST_CASE( PointsAndTimes )
+{
+    const Track track = restingWalk(1000);
+    const CompressedTrack compressed(track);
+
+    BOOST_CHECK_EQUAL( compressed.name(), track.name() );
+    BOOST_REQUIRE_EQUAL( compressed.numPositions(), track.numPositions() );
+    seconds rests = 0;
+    for (unsigned int i = 0; i < track.numPositions(); ++i)
+    {
+        BOOST_CHECK_SMALL( compressed[i].latitude() - track[i].latitude(), 0.51e-7 );
+        BOOST_CHECK_SMALL( compressed[i].longitude() - track[i].longitude(), 0.51e-7 );
+        BOOST_CHECK_SMALL( compressed[i].elevation() - track[i].elevation(), 0.51e-3 );
+        BOOST_CHECK( compressed.departedAt(i) >= compressed.arrivedAt(i) );
+        rests += compressed.departedAt(i) - compressed.arrivedAt(i);
+    }
+    BOOST_CHECK_EQUAL( rests, track.restingTime() );
+    BOOST_CHECK_EQUAL( compressed.departedAt(compressed.numPositions() - 1), track.totalTime() );
+    BOOST_CHECK_THROW( compressed[compressed.numPositions()], std::out_of_range );
+    BOOST_CHECK_THROW( compressed.arrivedAt(compressed.numPositions()), std::out_of_range );
+}
+
+// The analytics are exactly those of the Track.
+BOOST_AUTO_TEST_CASE( Analytics )
+{
+    const Track track = restingWalk(1000);
+    const CompressedTrack compressed(track);
+
+    BOOST_CHECK( track.restingTime() > 0 );
+    BOOST_CHECK_EQUAL( compressed.totalLength(), track.totalLength() );
+    BOOST_CHECK_EQUAL( compressed.totalTime(), track.totalTime() );
+    BOOST_CHECK_EQUAL( compressed.restingTime(), track.restingTime() );
+    BOOST_CHECK_EQUAL( compressed.travellingTime(), track.travellingTime() );
+    BOOST_CHECK_EQUAL( compressed.maxSpeed(), track.maxSpeed() );
+    BOOST_CHECK_EQUAL( compressed.averageSpeed(true), track.averageSpeed(true) );
+    BOOST_CHECK_EQUAL( compressed.averageSpeed(false), track.averageSpeed(false) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
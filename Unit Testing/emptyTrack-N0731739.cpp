@@ -0,0 +1,72 @@
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+
+#include "logs.h"
+#include "types.h"
+#include "track.h"
+#include "routecache.h"
+
+using namespace GPS;
+
+BOOST_AUTO_TEST_SUITE( Track_emptyTrack_N0731739 )
+
+const bool isFileName = true;
+
+// Checks that constructing a Track from "gpx" throws a std::domain_error with the message "expected".
+void checkRejected(const std::string & gpx, const std::string & expected)
+{
+    try
+    {
+        Track track(gpx, ! isFileName);
+        BOOST_ERROR( "No exception thrown." );
+    }
+    catch (const std::domain_error & e)
+    {
+        BOOST_CHECK_EQUAL( std::string(e.what()), expected );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( NoPoints )
+{
+    checkRejected("<gpx><trk><name>Empty</name></trk></gpx>", "No 'trkpt' element.");
+}
+
+BOOST_AUTO_TEST_CASE( EmptySegment )
+{
+    checkRejected("<gpx><trk><trkseg></trkseg></trk></gpx>", "No 'trkpt' element.");
+}
+
+// Points are read from the segments, so a point after an empty segment leaves the Track with none.
+BOOST_AUTO_TEST_CASE( PointOutsideEmptySegment )
+{
+    checkRejected("<gpx><trk><trkseg></trkseg><trkpt lat=\"1\" lon=\"1\"><time>1</time></trkpt></trk></gpx>",
+                  "No 'trkpt' element.");
+}
+
+// A live Track before its first point has an empty report, and can still be re-decimated.
+BOOST_AUTO_TEST_CASE( LiveTrackBeforeFirstPoint )
+{
+    Track track(10);
+    BOOST_CHECK_EQUAL( track.numPositions(), 0 );
+    BOOST_CHECK_EQUAL( track.totalLength(), 0 );
+    BOOST_CHECK_EQUAL( track.buildReport(), "0 positions added.\n" );
+
+    track.setGranularity(5);
+    BOOST_CHECK_EQUAL( track.numPositions(), 0 );
+    BOOST_CHECK_EQUAL( track.buildReport(), "0 positions added.\n" );
+
+    const Position start(52.9, -1.18, 40);
+    track.append(start, 100);
+    BOOST_CHECK_EQUAL( track.numPositions(), 1 );
+    BOOST_CHECK_EQUAL( track.buildReport(), "Start position added: " + start.toString() + "\n1 positions added.\n" );
+}
+
+// There is nothing to cache in a live Track before its first point.
+BOOST_AUTO_TEST_CASE( CacheLiveTrackBeforeFirstPoint )
+{
+    const Track track(10);
+    BOOST_CHECK_THROW( RouteCache::save(track, LogFiles::LogsDir + "emptyTrack_N0731739.cache"), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
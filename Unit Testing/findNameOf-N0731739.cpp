@@ -0,0 +1,140 @@
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+
+#include "types.h"
+#include "route.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+BOOST_AUTO_TEST_SUITE( Route_findNameOf_N0731739 )
+
+const bool isFileName = true;
+
+// A wandering route that then retraces part of its steps, with about one point in three named.
+struct RevisitingRoute
+{
+    std::vector<Position> points;
+    std::vector<std::string> names;
+
+    RevisitingRoute()
+    {
+        points = GeneratedLogs::randomWalk(300, 8);
+        for (unsigned int i = 0; i < 100; ++i) points.push_back(points[250 - 2 * i]);
+        for (unsigned int i = 0; i < points.size(); ++i)
+        {
+            names.push_back(i % 3 == 0 ? "P" + std::to_string(i) : "");
+        }
+    }
+
+    // The names of the points that a Route with this granularity keeps, found by a linear scan.
+    std::vector<std::string> keptNames(metres granularity) const
+    {
+        std::vector<std::string> kept = { names[0] };
+        Position last = points[0];
+        for (unsigned int i = 1; i < points.size(); ++i)
+        {
+            if (Position::distanceBetween(points[i], last) >= granularity)
+            {
+                kept.push_back(names[i]);
+                last = points[i];
+            }
+        }
+        return kept;
+    }
+
+    // The points to look up: every route point, points a few metres from them, and points far away.
+    std::vector<Position> queries() const
+    {
+        std::vector<Position> sought;
+        for (const Position & point : points)
+        {
+            sought.push_back(point);
+            sought.push_back(Position(point.latitude() + 0.00012, point.longitude() - 0.00007, 0));
+        }
+        sought.push_back(Position(0, 0, 0));
+        sought.push_back(Position(-52.9, 178.82, 0));
+        return sought;
+    }
+};
+
+// The index of the first route point within the granularity, found by a linear scan; -1 if there is none.
+int linearFind(const Route & route, const Position & soughtPos, metres granularity)
+{
+    for (unsigned int i = 0; i < route.numPositions(); ++i)
+    {
+        if (Position::distanceBetween(route[i], soughtPos) < granularity) return (int)i;
+    }
+    return -1;
+}
+
+unsigned int linearTimesVisited(const Route & route, const Position & soughtPos, metres granularity)
+{
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < route.numPositions(); ++i)
+    {
+        if (Position::distanceBetween(route[i], soughtPos) < granularity) ++count;
+    }
+    return count;
+}
+
+const metres granularities[] = { 0, 5, 20, 60 };
+
+// The name found is that of the first route point within the granularity, as a linear search finds.
+BOOST_AUTO_TEST_CASE( SameAsLinearSearch )
+{
+    const RevisitingRoute generated;
+    for (metres granularity : granularities)
+    {
+        Route route(GeneratedLogs::routeGPX(generated.points, generated.names), ! isFileName, granularity);
+        const std::vector<std::string> names = generated.keptNames(granularity);
+        BOOST_REQUIRE_EQUAL( route.numPositions(), names.size() );
+
+        for (const Position & soughtPos : generated.queries())
+        {
+            int found = linearFind(route, soughtPos, granularity);
+            if (found < 0)
+            {
+                BOOST_CHECK_THROW( route.findNameOf(soughtPos), std::out_of_range );
+            }
+            else
+            {
+                BOOST_CHECK_EQUAL( route.findNameOf(soughtPos), names[found] );
+            }
+        }
+    }
+}
+
+// Every route point within the granularity is counted, as a linear scan counts them.
+BOOST_AUTO_TEST_CASE( TimesVisitedSameAsLinearScan )
+{
+    const RevisitingRoute generated;
+    for (metres granularity : granularities)
+    {
+        Route route(GeneratedLogs::routeGPX(generated.points, generated.names), ! isFileName, granularity);
+        for (const Position & soughtPos : generated.queries())
+        {
+            BOOST_CHECK_EQUAL( route.timesVisited(soughtPos), linearTimesVisited(route, soughtPos, granularity) );
+        }
+    }
+}
+
+// The index is rebuilt when the granularity changes.
+BOOST_AUTO_TEST_CASE( AfterSetGranularity )
+{
+    const RevisitingRoute generated;
+    Route route(GeneratedLogs::routeGPX(generated.points, generated.names), ! isFileName, 5);
+    route.timesVisited(generated.points[0]);
+    route.setGranularity(60);
+
+    const std::vector<std::string> names = generated.keptNames(60);
+    for (const Position & soughtPos : generated.queries())
+    {
+        BOOST_CHECK_EQUAL( route.timesVisited(soughtPos), linearTimesVisited(route, soughtPos, 60) );
+        int found = linearFind(route, soughtPos, 60);
+        if (found >= 0) BOOST_CHECK_EQUAL( route.findNameOf(soughtPos), names[found] );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
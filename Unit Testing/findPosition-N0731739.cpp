@@ -0,0 +1,138 @@
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+
+#include "types.h"
+#include "route.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+BOOST_AUTO_TEST_SUITE( Route_findPosition_N0731739 )
+
+const bool isFileName = true;
+
+// Names that repeat along a route that retraces its steps; some points are unnamed.
+struct RepeatedNames
+{
+    std::vector<Position> points;
+    std::vector<std::string> names;
+
+    RepeatedNames()
+    {
+        points = GeneratedLogs::randomWalk(200, 9);
+        for (unsigned int i = 0; i < 80; ++i) points.push_back(points[190 - 2 * i]);
+        for (unsigned int i = 0; i < points.size(); ++i)
+        {
+            names.push_back(i % 4 == 0 ? "" : "N" + std::to_string(i % 37));
+        }
+    }
+
+    // The names of the points that a Route with this granularity keeps.
+    std::vector<std::string> keptNames(metres granularity) const
+    {
+        std::vector<std::string> kept = { names[0] };
+        Position last = points[0];
+        for (unsigned int i = 1; i < points.size(); ++i)
+        {
+            if (Position::distanceBetween(points[i], last) >= granularity)
+            {
+                kept.push_back(names[i]);
+                last = points[i];
+            }
+        }
+        return kept;
+    }
+};
+
+// The index of the first route point with the name, as a linear search finds it; -1 if there is none.
+int linearFind(const std::vector<std::string> & names, const std::string & soughtName)
+{
+    for (unsigned int i = 0; i < names.size(); ++i)
+    {
+        if (names[i] == soughtName) return (int)i;
+    }
+    return -1;
+}
+
+// The lookups: every name used, the empty name of the unnamed points, and names not used at all.
+std::vector<std::string> soughtNames()
+{
+    std::vector<std::string> sought = { "", "N", "N37", "Nothing" };
+    for (unsigned int i = 0; i < 37; ++i) sought.push_back("N" + std::to_string(i));
+    return sought;
+}
+
+const metres granularities[] = { 0, 5, 20, 60 };
+
+// findPosition() returns the first point with the name, or throws if there is none.
+BOOST_AUTO_TEST_CASE( SameAsLinearSearch )
+{
+    const RepeatedNames generated;
+    for (metres granularity : granularities)
+    {
+        Route route(GeneratedLogs::routeGPX(generated.points, generated.names), ! isFileName, granularity);
+        const std::vector<std::string> names = generated.keptNames(granularity);
+        BOOST_REQUIRE_EQUAL( route.numPositions(), names.size() );
+
+        for (const std::string & soughtName : soughtNames())
+        {
+            int found = linearFind(names, soughtName);
+            if (found < 0)
+            {
+                BOOST_CHECK_THROW( route.findPosition(soughtName), std::out_of_range );
+            }
+            else
+            {
+                Position position = route.findPosition(soughtName);
+                BOOST_CHECK_EQUAL( position.latitude(), route[found].latitude() );
+                BOOST_CHECK_EQUAL( position.longitude(), route[found].longitude() );
+            }
+        }
+    }
+}
+
+// timesVisited() counts the visits to the first point with the name, and is 0 for a name not on the route.
+BOOST_AUTO_TEST_CASE( TimesVisitedSameAsLinearScan )
+{
+    const RepeatedNames generated;
+    for (metres granularity : granularities)
+    {
+        Route route(GeneratedLogs::routeGPX(generated.points, generated.names), ! isFileName, granularity);
+        const std::vector<std::string> names = generated.keptNames(granularity);
+
+        for (const std::string & soughtName : soughtNames())
+        {
+            unsigned int expected = 0;
+            int found = linearFind(names, soughtName);
+            if (found >= 0)
+            {
+                for (unsigned int i = 0; i < route.numPositions(); ++i)
+                {
+                    if (Position::distanceBetween(route[i], route[found]) < granularity) ++expected;
+                }
+            }
+            BOOST_CHECK_EQUAL( route.timesVisited(soughtName), expected );
+            BOOST_CHECK_EQUAL( route.timesVisited(soughtName), found < 0 ? 0 : route.timesVisited(route[found]) );
+        }
+    }
+}
+
+// The name index is rebuilt when the granularity changes.
+BOOST_AUTO_TEST_CASE( AfterSetGranularity )
+{
+    const RepeatedNames generated;
+    Route route(GeneratedLogs::routeGPX(generated.points, generated.names), ! isFileName, 60);
+    route.timesVisited("N1");
+    route.setGranularity(5);
+
+    const std::vector<std::string> names = generated.keptNames(5);
+    for (const std::string & soughtName : soughtNames())
+    {
+        int found = linearFind(names, soughtName);
+        if (found < 0) continue;
+        BOOST_CHECK_EQUAL( route.findPosition(soughtName).latitude(), route[found].latitude() );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
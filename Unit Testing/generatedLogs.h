@@ -0,0 +1,109 @@
+#ifndef GENERATEDLOGS_H
+#define GENERATEDLOGS_H
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+
+#include "types.h"
+#include "position.h"
+
+/* GPX and NMEA data generated rather than read from the log files, for tests and timing programs
+ * that need many points or particular spacings.  Coordinates are written with 17 significant digits,
+ * so the Positions read back are exactly those given.
+ */
+namespace GeneratedLogs
+{
+  // GPX for a route through "points"; point i is named names[i], if that is not empty.
+  inline std::string routeGPX(const std::vector<GPS::Position> & points,
+                              const std::vector<std::string> & names = std::vector<std::string>())
+  {
+      std::ostringstream gpx;
+      gpx << std::setprecision(17);
+      gpx << "<?xml version=\"1.0\"?>\n<gpx version=\"1.1\"><rte><name>Generated</name>\n";
+      for (unsigned int i = 0; i < points.size(); ++i)
+      {
+          gpx << "<rtept lat=\"" << points[i].latitude() << "\" lon=\"" << points[i].longitude() << "\">"
+              << "<ele>" << points[i].elevation() << "</ele>";
+          if (i < names.size() && ! names[i].empty()) gpx << "<name>" << names[i] << "</name>";
+          gpx << "</rtept>\n";
+      }
+      gpx << "</rte></gpx>\n";
+      return gpx.str();
+  }
+
+  // GPX for a track through "points" at "times"; point i is named names[i], if that is not empty.
+  inline std::string trackGPX(const std::vector<GPS::Position> & points, const std::vector<GPS::seconds> & times,
+                              const std::vector<std::string> & names = std::vector<std::string>())
+  {
+      std::ostringstream gpx;
+      gpx << std::setprecision(17);
+      gpx << "<?xml version=\"1.0\"?>\n<gpx version=\"1.1\"><trk><name>Generated</name><trkseg>\n";
+      for (unsigned int i = 0; i < points.size(); ++i)
+      {
+          gpx << "<trkpt lat=\"" << points[i].latitude() << "\" lon=\"" << points[i].longitude() << "\">"
+              << "<ele>" << points[i].elevation() << "</ele><time>" << times[i] << "</time>";
+          if (i < names.size() && ! names[i].empty()) gpx << "<name>" << names[i] << "</name>";
+          gpx << "</trkpt>\n";
+      }
+      gpx << "</trkseg></trk></gpx>\n";
+      return gpx.str();
+  }
+
+  /* A wandering walk of "numPoints" points near Nottingham, with steps of up to about 40m that
+   * often double back, so that many points lie within a few granularities of earlier ones.
+   * The same "seed" always gives the same walk.
+   */
+  inline std::vector<GPS::Position> randomWalk(unsigned int numPoints, unsigned int seed)
+  {
+      std::vector<GPS::Position> points;
+      double lat = 52.9, lon = -1.18, ele = 50;
+      unsigned long long state = seed * 2654435761ULL + 1;
+      auto next = [&state]() // A linear congruential generator, so the walk is the same on every platform.
+      {
+          state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+          return (double)(state >> 11) / (double)(1ULL << 53);
+      };
+      for (unsigned int i = 0; i < numPoints; ++i)
+      {
+          points.push_back(GPS::Position(lat, lon, ele));
+          lat += (next() - 0.5) * 0.0006;
+          lon += (next() - 0.5) * 0.0009;
+          ele += (next() - 0.5) * 8;
+      }
+      return points;
+  }
+
+  // A complete NMEA sentence: "$", "body", "*", the checksum (or, if "corrupt", a wrong one) and CRLF.
+  inline std::string withChecksum(const std::string & body, bool corrupt = false)
+  {
+      unsigned char checksum = 0;
+      for (char c : body) checksum ^= (unsigned char)c;
+      char digits[3];
+      std::snprintf(digits, sizeof(digits), "%02X", corrupt ? checksum ^ 1 : checksum);
+      return "$" + body + "*" + digits + "\r\n";
+  }
+
+  // An NMEA log of at least "numBytes" characters: a GGA and an RMC sentence each second, with one GGA in fifty corrupt.
+  inline std::string nmeaLog(std::size_t numBytes)
+  {
+      std::string log;
+      log.reserve(numBytes + 200);
+      for (unsigned int i = 0; log.size() < numBytes; ++i)
+      {
+          const unsigned int time = i % 86400;
+          char body[160];
+          std::snprintf(body, sizeof(body), "GPGGA,%02u%02u%02u.00,5256.%04u,N,00108.%04u,W,1,08,0.9,%u.4,M,46.9,M,,",
+                        time / 3600, time / 60 % 60, time % 60, i % 10000, (i * 7) % 10000, i % 300);
+          log += withChecksum(body, i % 50 == 0);
+          std::snprintf(body, sizeof(body), "GPRMC,%02u%02u%02u.00,A,5256.%04u,N,00108.%04u,W,0.5,54.7,191194,020.3,E",
+                        time / 3600, time / 60 % 60, time % 60, i % 10000, (i * 7) % 10000);
+          log += withChecksum(body);
+      }
+      return log;
+  }
+}
+
+#endif
@@ -0,0 +1,166 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cctype>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "parseNMEA.h"
+#include "nmeaFields.h"
+#include "nmeaIndex.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+BOOST_AUTO_TEST_SUITE( NMEA_isValidSentence_N0731739 )
+
+// isValidSentence(const std::string &) as it was before it stopped copying the checksum.
+bool baselineIsValidSentence(const std::string & theLog)
+{
+    if (! isxdigit(theLog.at(theLog.size() - 2))) return false;
+
+    int hex = stol(theLog.substr(theLog.size() - 2), 0, 16);
+    int checksum = 0;
+    for (size_t i = 1; i + 3 < theLog.size(); i++) checksum ^= theLog[i];
+    return checksum == hex;
+}
+
+// Sentences of every kind: well formed, with wrong or partly hexadecimal checksums, without '$' or '*', and truncated.
+std::vector<std::string> generatedSentences(bool asciiOnly)
+{
+    const std::string alphabet = "GPRMCA0123456789.,NSEW";
+    const std::string endings[] = { "", "*", "*0", "*x", "*A,", "*g5", "*0x", "*3 ", "*f", "*Ff" };
+    unsigned long long state = 77;
+    auto next = [&state](unsigned int range)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (unsigned int)((state >> 33) % range);
+    };
+
+    std::vector<std::string> sentences;
+    for (unsigned int n = 0; n < 20000; ++n)
+    {
+        std::string body = "GP";
+        const unsigned int length = next(40);
+        for (unsigned int i = 0; i < length; ++i)
+        {
+            body += (! asciiOnly && next(50) == 0) ? (char)(0x80 + next(128)) : alphabet[next(alphabet.size())];
+        }
+
+        std::string sentence = GeneratedLogs::withChecksum(body, next(3) == 0);
+        sentence.resize(sentence.size() - 2); // No CRLF.
+        switch (next(6))
+        {
+          case 0: // Lower case checksum.
+            for (std::size_t i = sentence.size() - 2; i < sentence.size(); ++i) sentence[i] = (char)std::tolower(sentence[i]);
+            break;
+          case 1: // Something other than a valid checksum.
+            sentence = "$" + body + endings[next(10)];
+            break;
+          case 2: // No '$'.
+            sentence.erase(0, 1);
+            break;
+        }
+        if (sentence.size() >= 2) sentences.push_back(sentence);
+    }
+    return sentences;
+}
+
+// The string version accepts and rejects exactly what it did when it copied the checksum.
+BOOST_AUTO_TEST_CASE( SameAsBaseline )
+{
+    for (const std::string & sentence : generatedSentences(false))
+    {
+        BOOST_CHECK_MESSAGE( isValidSentence(sentence) == baselineIsValidSentence(sentence), sentence );
+    }
+    BOOST_CHECK_THROW( isValidSentence(""), std::out_of_range );
+    BOOST_CHECK_THROW( isValidSentence("$"), std::out_of_range );
+}
+
+// For sentences with a '$' and a two digit checksum after a '*', the view version agrees with the string version.
+BOOST_AUTO_TEST_CASE( ViewSameAsString )
+{
+    for (const std::string & sentence : generatedSentences(true))
+    {
+        const bool wellFormed = sentence.size() >= 4 && sentence[0] == '$' && sentence[sentence.size() - 3] == '*'
+                             && std::isxdigit((unsigned char)sentence[sentence.size() - 2])
+                             && std::isxdigit((unsigned char)sentence[sentence.size() - 1]);
+        if (wellFormed)
+        {
+            BOOST_CHECK_MESSAGE( isValidSentence(TextView(sentence)) == isValidSentence(sentence), sentence );
+        }
+        else
+        {
+            BOOST_CHECK_MESSAGE( ! isValidSentence(TextView(sentence)), sentence );
+        }
+    }
+}
+
+// The view version of decomposeSentence() splits a sentence into the same type and fields as the string version.
+BOOST_AUTO_TEST_CASE( DecomposeViewSameAsString )
+{
+    for (const std::string & sentence : generatedSentences(true))
+    {
+        if (sentence[0] != '$' || sentence.find('*') == std::string::npos) continue;
+
+        const NMEAPair expected = decomposeSentence(sentence);
+        NMEAFields fields;
+        BOOST_REQUIRE( decomposeSentence(TextView(sentence), fields) );
+        BOOST_CHECK_EQUAL( fields.type.str(), expected.first );
+        BOOST_REQUIRE_EQUAL( fields.numFields, expected.second.size() );
+        for (std::size_t i = 0; i < fields.numFields; ++i)
+        {
+            BOOST_CHECK_EQUAL( fields.fields[i].str(), expected.second[i] );
+        }
+    }
+}
+
+// The index of a whole log finds each sentence valid or not as the view version does, with the same fields.
+BOOST_AUTO_TEST_CASE( IndexSameAsSentences )
+{
+    std::vector<std::string> sentences;
+    std::string log;
+    for (const std::string & sentence : generatedSentences(true))
+    {
+        if (sentence[0] != '$' || sentence.size() < 4 || sentence[sentence.size() - 3] != '*') continue;
+        sentences.push_back(sentence);
+        log += sentence + "\r\n";
+    }
+
+    NMEAIndex index;
+    index.build(TextView(log));
+    BOOST_REQUIRE_EQUAL( index.numSentences(), sentences.size() );
+    for (std::size_t i = 0; i < sentences.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL( index.sentence(i).str(), sentences[i] );
+        BOOST_CHECK_EQUAL( index.isValid(i), isValidSentence(TextView(sentences[i])) );
+
+        NMEAFields expected, indexed;
+        decomposeSentence(TextView(sentences[i]), expected);
+        BOOST_REQUIRE( index.decompose(i, indexed) );
+        BOOST_CHECK_EQUAL( indexed.type.str(), expected.type.str() );
+        BOOST_REQUIRE_EQUAL( indexed.numFields, expected.numFields );
+        for (std::size_t f = 0; f < expected.numFields; ++f)
+        {
+            BOOST_CHECK_EQUAL( indexed.fields[f].str(), expected.fields[f].str() );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( HexDigitValue )
+{
+    const std::string digits = "0123456789abcdef";
+    for (int value = 0; value < 16; ++value)
+    {
+        BOOST_CHECK_EQUAL( hexDigitValue(digits[value]), value );
+        BOOST_CHECK_EQUAL( hexDigitValue((char)std::toupper(digits[value])), value );
+    }
+    for (char c : std::string("gGxX ,*$\n/:@`"))
+    {
+        BOOST_CHECK_EQUAL( hexDigitValue(c), -1 );
+    }
+    BOOST_CHECK_EQUAL( hexDigitValue((char)0xB0), -1 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
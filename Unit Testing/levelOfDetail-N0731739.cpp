@@ -0,0 +1,144 @@
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <utility>
+
+#include "types.h"
+#include "route.h"
+#include "track.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+BOOST_AUTO_TEST_SUITE( Route_levelOfDetail_N0731739 )
+
+const bool isFileName = true;
+const metres granularity = 10;
+
+// A random walk that ends with a few points within a metre or two of each other.
+std::vector<Position> walkWithTail()
+{
+    std::vector<Position> points = GeneratedLogs::randomWalk(3000, 21);
+    const Position last = points.back();
+    for (int i = 1; i <= 4; ++i)
+    {
+        points.push_back(Position(last.latitude() + i * 0.00001, last.longitude(), last.elevation()));
+    }
+    return points;
+}
+
+// The number of levels: the spacing doubles until the coarsest level, then stays the same.
+unsigned int numLevels(const Route & route)
+{
+    unsigned int levels = 1;
+    while (route.levelOfDetail(granularity * (1 << levels)).spacing() == granularity * (1 << levels)) ++levels;
+    return levels;
+}
+
+bool samePoint(const Position & p1, const Position & p2)
+{
+    return p1.latitude() == p2.latitude() && p1.longitude() == p2.longitude() && p1.elevation() == p2.elevation();
+}
+
+BOOST_AUTO_TEST_CASE( GranularityDoubles )
+{
+    const Route route(GeneratedLogs::routeGPX(walkWithTail()), ! isFileName, granularity);
+    const unsigned int levels = numLevels(route);
+    BOOST_REQUIRE( levels >= 4 );
+
+    for (unsigned int k = 0; k < levels; ++k)
+    {
+        const metres spacing = granularity * (1 << k);
+        BOOST_CHECK_EQUAL( route.levelOfDetail(spacing).spacing(), spacing );
+        BOOST_CHECK_EQUAL( route.levelOfDetail(spacing * 1.99).spacing(), spacing ); // The coarsest not exceeding the tolerance.
+        if (k > 0) BOOST_CHECK( route.levelOfDetail(spacing).size() <= route.levelOfDetail(spacing / 2).size() );
+    }
+    BOOST_CHECK_EQUAL( route.levelOfDetail(0).spacing(), granularity );
+    BOOST_CHECK_EQUAL( route.levelOfDetail(1e9).size(), 2 );
+}
+
+// Every level starts and ends where the Route does, and its other points are at least its spacing apart.
+BOOST_AUTO_TEST_CASE( FirstAndLastKept )
+{
+    const Route route(GeneratedLogs::routeGPX(walkWithTail()), ! isFileName, granularity);
+    const unsigned int levels = numLevels(route);
+
+    for (unsigned int k = 0; k < levels; ++k)
+    {
+        const DetailLevel level = route.levelOfDetail(granularity * (1 << k));
+        BOOST_REQUIRE( level.size() >= 2 );
+        BOOST_CHECK( samePoint(level[0], route[0]) );
+        BOOST_CHECK( samePoint(level[level.size() - 1], route[route.numPositions() - 1]) );
+        for (std::size_t i = 1; i + 1 < level.size(); ++i)
+        {
+            BOOST_CHECK( Position::distanceBetween(level[i], level[i - 1]) >= level.spacing() );
+            BOOST_CHECK( level.sourceIndex(i) > level.sourceIndex(i - 1) );
+        }
+    }
+}
+
+/* Each level holds the points that setGranularity() keeps at its spacing, except that it ends at the
+ * last point of the Route: any points kept after that are dropped, being within "granularity" of it.
+ */
+BOOST_AUTO_TEST_CASE( SameAsSetGranularity )
+{
+    const std::vector<Position> points = walkWithTail();
+    std::map<std::pair<degrees, degrees>, unsigned int> indexOf;
+    for (unsigned int i = 0; i < points.size(); ++i) indexOf[{ points[i].latitude(), points[i].longitude() }] = i;
+
+    const Route route(GeneratedLogs::routeGPX(points), ! isFileName, granularity);
+    const Position end = route[route.numPositions() - 1];
+    const unsigned int endIndex = indexOf.at({ end.latitude(), end.longitude() });
+    const unsigned int levels = numLevels(route);
+
+    for (unsigned int k = 0; k < levels; ++k)
+    {
+        const metres spacing = granularity * (1 << k);
+        Route fresh(GeneratedLogs::routeGPX(points), ! isFileName, granularity);
+        fresh.setGranularity(spacing);
+
+        std::vector<Position> expected;
+        for (unsigned int i = 0; i < fresh.numPositions(); ++i)
+        {
+            if (indexOf.at({ fresh[i].latitude(), fresh[i].longitude() }) < endIndex) expected.push_back(fresh[i]);
+        }
+        expected.push_back(end);
+
+        const DetailLevel level = route.levelOfDetail(spacing);
+        BOOST_REQUIRE_EQUAL( level.size(), expected.size() );
+        for (std::size_t i = 0; i < expected.size(); ++i)
+        {
+            BOOST_CHECK( samePoint(level[i], expected[i]) );
+            BOOST_CHECK_EQUAL( level.sourceIndex(i), indexOf.at({ expected[i].latitude(), expected[i].longitude() }) );
+        }
+    }
+}
+
+// The levels are rebuilt when the Route changes.
+BOOST_AUTO_TEST_CASE( Rebuilt )
+{
+    const std::vector<Position> points = GeneratedLogs::randomWalk(1000, 22);
+    std::vector<seconds> times;
+    for (unsigned int i = 0; i < points.size(); ++i) times.push_back(i);
+
+    Track live(granularity);
+    for (unsigned int i = 0; i < 500; ++i) live.append(points[i], times[i]);
+    BOOST_CHECK( samePoint(live.levelOfDetail(80)[live.levelOfDetail(80).size() - 1], live[live.numPositions() - 1]) );
+    for (unsigned int i = 500; i < points.size(); ++i) live.append(points[i], times[i]);
+
+    const Track parsed(GeneratedLogs::trackGPX(points, times), ! isFileName, granularity);
+    for (metres tolerance : { 10.0, 40.0, 160.0 })
+    {
+        const DetailLevel fromLive = live.levelOfDetail(tolerance), fromParsed = parsed.levelOfDetail(tolerance);
+        BOOST_REQUIRE_EQUAL( fromLive.size(), fromParsed.size() );
+        for (std::size_t i = 0; i < fromLive.size(); ++i) BOOST_CHECK( samePoint(fromLive[i], fromParsed[i]) );
+    }
+
+    Route route(GeneratedLogs::routeGPX(points), ! isFileName, granularity);
+    const std::size_t before = route.levelOfDetail(granularity).size();
+    route.setGranularity(4 * granularity);
+    BOOST_CHECK( route.levelOfDetail(4 * granularity).size() < before );
+    BOOST_CHECK_EQUAL( route.levelOfDetail(4 * granularity).size(), route.numPositions() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,76 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <fstream>
+
+#include "logs.h"
+#include "mappedfile.h"
+
+using namespace GPS;
+
+BOOST_AUTO_TEST_SUITE( MappedFile_N0731739 )
+
+const bool isFileName = true;
+
+std::string writeLogFile(const std::string & filePath, const std::string & contents)
+{
+    std::ofstream file(filePath, std::ios::binary);
+    file << contents;
+    file.close();
+    return filePath;
+}
+
+BOOST_AUTO_TEST_CASE( NormalFile )
+{
+    std::string contents = "<gpx>\n";
+    for (int i = 0; i < 10000; ++i) contents += "<rtept lat=\"52.9\" lon=\"-1.1\"></rtept>\n";
+    contents += std::string(1, '\0') + "</gpx>";
+    const std::string filePath = writeLogFile(LogFiles::LogsDir + "mappedFile_N0731739.gpx", contents);
+
+    MappedFile file;
+    BOOST_REQUIRE( file.open(filePath) );
+    BOOST_CHECK_EQUAL( file.size(), contents.size() );
+    BOOST_CHECK( file.view().str() == contents );
+    BOOST_CHECK( file.view().first == file.begin() );
+
+    file.close();
+    BOOST_CHECK_EQUAL( file.size(), 0 );
+    BOOST_CHECK( file.begin() != nullptr );
+}
+
+// An empty file opens, with an empty view that still points somewhere.
+BOOST_AUTO_TEST_CASE( EmptyFile )
+{
+    const std::string filePath = writeLogFile(LogFiles::LogsDir + "mappedFile_N0731739.empty", "");
+
+    MappedFile file;
+    BOOST_REQUIRE( file.open(filePath) );
+    BOOST_CHECK_EQUAL( file.size(), 0 );
+    BOOST_CHECK( file.begin() != nullptr );
+    BOOST_CHECK( file.view().first != nullptr );
+    BOOST_CHECK( file.view().empty() );
+    BOOST_CHECK_EQUAL( file.view().str(), "" );
+
+    const MappedFile unopened;
+    BOOST_CHECK_EQUAL( unopened.size(), 0 );
+    BOOST_CHECK( unopened.begin() != nullptr );
+}
+
+// A file that cannot be read leaves nothing open, even if another file was open before.
+BOOST_AUTO_TEST_CASE( MissingFile )
+{
+    const std::string filePath = writeLogFile(LogFiles::LogsDir + "mappedFile_N0731739.gpx", "<gpx></gpx>");
+
+    MappedFile file;
+    BOOST_REQUIRE( file.open(filePath) );
+    BOOST_CHECK( ! file.open(LogFiles::LogsDir + "mappedFile_N0731739.missing") );
+    BOOST_CHECK_EQUAL( file.size(), 0 );
+    BOOST_CHECK( file.begin() != nullptr );
+    BOOST_CHECK( file.view().empty() );
+
+    BOOST_CHECK( ! file.open(LogFiles::LogsDir) ); // A directory, not a file.
+    BOOST_CHECK_EQUAL( file.size(), 0 );
+    BOOST_CHECK( file.begin() != nullptr );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
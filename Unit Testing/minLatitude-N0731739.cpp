@@ -0,0 +1,63 @@
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "types.h"
+#include "route.h"
+#include "track.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+BOOST_AUTO_TEST_SUITE( Route_minLatitude_N0731739 )
+
+const bool isFileName = true;
+
+// Successive points are more than 0.5km apart, so none is discarded.
+const std::vector<Position> points = { Position(52.90, -1.18, 40), Position(52.89, -1.18, 40),
+                                       Position(52.89005, -1.19, 40), Position(52.894, -1.18, 40) };
+
+degrees trueMinimum(const std::vector<Position> & positions)
+{
+    degrees lowest = positions.front().latitude();
+    for (const Position & position : positions) lowest = std::min(lowest, position.latitude());
+    return lowest;
+}
+
+// A latitude slightly above the minimum does not replace it, as it did with the old epsilon comparison.
+BOOST_AUTO_TEST_CASE( SlightlyAboveMinimum )
+{
+    Route route(GeneratedLogs::routeGPX(points), ! isFileName, 0);
+    BOOST_REQUIRE_EQUAL( route.numPositions(), points.size() );
+    BOOST_CHECK_EQUAL( route.minLatitude(), 52.89 );
+}
+
+// Whatever the storage and however the points arrive, the result is the lowest latitude.
+BOOST_AUTO_TEST_CASE( SameEveryWay )
+{
+    const std::vector<Position> walk = GeneratedLogs::randomWalk(2000, 9);
+    std::vector<seconds> times;
+    for (unsigned int i = 0; i < walk.size(); ++i) times.push_back(i);
+
+    ParseOptions arrays;
+    arrays.storage = PositionStorage::Arrays;
+    Route objectsRoute(GeneratedLogs::routeGPX(walk), ! isFileName, 0);
+    Route arraysRoute(GeneratedLogs::routeGPX(walk), ! isFileName, 0, arrays);
+    Track live(0);
+    live.append(walk[0], times[0]);
+    BOOST_CHECK_EQUAL( live.minLatitude(), walk[0].latitude() ); // Caches the statistics, which append() then extends.
+    for (unsigned int i = 1; i < walk.size(); ++i) live.append(walk[i], times[i]);
+
+    BOOST_CHECK_EQUAL( objectsRoute.minLatitude(), trueMinimum(walk) );
+    BOOST_CHECK_EQUAL( arraysRoute.minLatitude(), trueMinimum(walk) );
+    BOOST_CHECK_EQUAL( live.minLatitude(), trueMinimum(walk) );
+}
+
+BOOST_AUTO_TEST_CASE( Empty )
+{
+    const Track live(10);
+    BOOST_CHECK_THROW( live.minLatitude(), std::out_of_range );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
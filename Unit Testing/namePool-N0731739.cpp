@@ -0,0 +1,166 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "logs.h"
+#include "types.h"
+#include "route.h"
+#include "namepool.h"
+#include "routecache.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+BOOST_AUTO_TEST_SUITE( NamePool_N0731739 )
+
+const bool isFileName = true;
+const std::string cacheFile = LogFiles::LogsDir + "namePool_N0731739.cache";
+
+// UTF-8 names, several bytes per character.
+const std::vector<std::string> nonASCII = { "Caf\xC3\xA9", "\xC5\x81\xC3\xB3""d\xC5\xBA", "\xE6\x9D\xB1\xE4\xBA\xAC", "\xF0\x9F\x9A\xB2" };
+
+BOOST_AUTO_TEST_CASE( EmptyName )
+{
+    NamePool pool;
+    const NameHandle handle = pool.add(std::string());
+    BOOST_CHECK( handle.empty() );
+    BOOST_CHECK_EQUAL( handle.offset, 0 );
+    BOOST_CHECK_EQUAL( pool.size(), 0 );
+    BOOST_CHECK_EQUAL( pool.str(handle), "" );
+    BOOST_CHECK( pool.equals(handle, "") );
+    BOOST_CHECK( ! pool.equals(handle, "A") );
+
+    pool.add("Start");
+    const NameHandle later = pool.add(TextView());
+    BOOST_CHECK( later.empty() );
+    BOOST_CHECK_EQUAL( pool.size(), 5 );
+    BOOST_CHECK_EQUAL( pool.str(later), "" );
+}
+
+// Each addition of a name is stored separately, and every handle stays valid as the pool grows.
+BOOST_AUTO_TEST_CASE( RepeatedNames )
+{
+    NamePool pool;
+    std::vector<NameHandle> handles;
+    for (unsigned int i = 0; i < 10000; ++i) handles.push_back(pool.add(i % 2 == 0 ? "Bridge" : "Bridges"));
+
+    BOOST_CHECK_EQUAL( pool.size(), 5000 * (6 + 7) );
+    for (unsigned int i = 0; i < handles.size(); ++i)
+    {
+        const std::string name = i % 2 == 0 ? "Bridge" : "Bridges";
+        BOOST_CHECK_EQUAL( pool.str(handles[i]), name );
+        BOOST_CHECK( pool.equals(handles[i], name) );
+        BOOST_CHECK( ! pool.equals(handles[i], i % 2 == 0 ? "Bridges" : "Bridge") );
+    }
+    BOOST_CHECK( handles[0].offset != handles[2].offset );
+}
+
+// Lengths are in bytes, and the bytes come back unchanged.
+BOOST_AUTO_TEST_CASE( NonASCIINames )
+{
+    NamePool pool;
+    std::vector<NameHandle> handles;
+    for (const std::string & name : nonASCII) handles.push_back(pool.add(name));
+
+    for (unsigned int i = 0; i < nonASCII.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL( handles[i].length, nonASCII[i].size() );
+        BOOST_CHECK_EQUAL( pool.str(handles[i]), nonASCII[i] );
+        BOOST_CHECK( pool.equals(handles[i], nonASCII[i]) );
+    }
+    BOOST_CHECK( ! pool.equals(handles[0], "Cafe") );
+
+    NamePool copy;
+    copy.assign(pool.data(), pool.size());
+    for (unsigned int i = 0; i < nonASCII.size(); ++i) BOOST_CHECK_EQUAL( copy.str(handles[i]), nonASCII[i] );
+}
+
+/* Points about 1.1km apart, so that all are kept at the default granularity, named with
+ * repeated, non-ASCII and empty names.
+ */
+struct NamedRoute
+{
+    std::vector<Position> points;
+    std::vector<std::string> names;
+
+    NamedRoute()
+    {
+        for (unsigned int i = 0; i < 40; ++i)
+        {
+            points.push_back(Position(52.5 + i * 0.01, -1.18, 40));
+            names.push_back(i % 3 == 0 ? "" : i % 3 == 1 ? nonASCII[i % nonASCII.size()] : "Gate");
+        }
+    }
+
+    // An empty <name> element for every unnamed point.
+    std::string gpx() const
+    {
+        std::string gpx = GeneratedLogs::routeGPX(points, names);
+        const std::string pointEnd = "</ele></rtept>";
+        for (std::size_t at = gpx.find(pointEnd); at != std::string::npos; at = gpx.find(pointEnd, at))
+        {
+            at += 6;
+            gpx.insert(at, "<name></name>");
+        }
+        return gpx;
+    }
+};
+
+void checkNames(const Route & route, const NamedRoute & named)
+{
+    BOOST_REQUIRE_EQUAL( route.numPositions(), named.points.size() );
+    for (unsigned int i = 0; i < named.points.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL( route.findNameOf(route[i]), named.names[i] );
+    }
+    BOOST_CHECK_EQUAL( route.findPosition(nonASCII[1]).latitude(), named.points[1].latitude() );
+    BOOST_CHECK_EQUAL( route.findPosition("Gate").latitude(), named.points[2].latitude() );
+    BOOST_CHECK_EQUAL( route.timesVisited("Gate"), 1 );
+}
+
+BOOST_AUTO_TEST_CASE( EmptyNameElement )
+{
+    const NamedRoute named;
+    const Route route(named.gpx(), ! isFileName);
+    checkNames(route, named);
+}
+
+// Decimating the points and then restoring them gives each point its own name back.
+BOOST_AUTO_TEST_CASE( NamesSurviveSetGranularity )
+{
+    const NamedRoute named;
+    Route route(named.gpx(), ! isFileName);
+
+    route.setGranularity(5000);
+    BOOST_REQUIRE( route.numPositions() < named.points.size() );
+    for (unsigned int i = 0; i < route.numPositions(); ++i)
+    {
+        const unsigned int index = (unsigned int)((route[i].latitude() - 52.5) / 0.01 + 0.5);
+        BOOST_CHECK_EQUAL( route.findNameOf(route[i]), named.names[index] );
+    }
+
+    route.setGranularity(20);
+    checkNames(route, named);
+}
+
+BOOST_AUTO_TEST_CASE( NamesSurviveRouteCache )
+{
+    const NamedRoute named;
+    Route route(named.gpx(), ! isFileName);
+    route.setGranularity(5000);
+    RouteCache::save(route, cacheFile);
+
+    std::unique_ptr<Route> loaded = RouteCache::loadRoute(cacheFile);
+    BOOST_REQUIRE_EQUAL( loaded->numPositions(), route.numPositions() );
+    for (unsigned int i = 0; i < route.numPositions(); ++i)
+    {
+        BOOST_CHECK_EQUAL( loaded->findNameOf((*loaded)[i]), route.findNameOf(route[i]) );
+    }
+
+    loaded->setGranularity(20); // The names of the discarded points were saved too.
+    checkNames(*loaded, named);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,450 @@
+#include <boost/test/unit_test.hpp>
+
+#include <list>
+#include <cstdio>
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+
+#include "primeFactorisation.h"
+#include "factorisationEngine.h"
+#include "batchFactorisation.h"
+#include "primeFactors.h"
+#include "spfCache.h"
+
+typedef unsigned long long int u64;
+
+/* The factorisations are checked against plain trial division, as primeFactorisation() did before
+ * it was optimised, where that is quick enough: for numbers below about 10^12.  Larger inputs are
+ * built as products of known primes, so their factors are known without factorising them. */
+namespace PrimeFactorisation_N0731739
+{
+  // The baseline: trial division by every number up to the square root.
+  std::list<u64> trialDivision(u64 x)
+  {
+      std::list<u64> factors;
+      if (x <= 1) return factors;
+      for (u64 d = 2; d <= x / d; ++d)
+      {
+          while (x % d == 0)
+          {
+              factors.push_back(d);
+              x /= d;
+          }
+      }
+      if (x > 1) factors.push_back(x);
+      return factors;
+  }
+
+  // Primes near the top of each range.
+  const u64 largePrimes[] = { 1000000007ULL, 1000000009ULL, 2147483647ULL, 3037000453ULL, 3037000493ULL,
+                              4294967279ULL, 4294967291ULL, 999999000001ULL, 2305843009213693951ULL,
+                              9223372036854775783ULL, 18446744073709551557ULL };
+
+  struct KnownFactorisation
+  {
+      u64 x;
+      std::list<u64> factors;
+  };
+
+  // Products of the large primes and small ones: semiprimes near 2^63, squares of large primes, and so on.
+  std::vector<KnownFactorisation> knownFactorisations()
+  {
+      std::vector<KnownFactorisation> known = {
+          { 0, {} }, { 1, {} }, { 2, { 2 } }, { 3, { 3 } }, { 4, { 2, 2 } },
+          { 3037000453ULL * 3037000493ULL, { 3037000453ULL, 3037000493ULL } },                  // Just below 2^63.
+          { 3037000493ULL * 3037000493ULL, { 3037000493ULL, 3037000493ULL } },
+          { 4294967291ULL * 4294967291ULL, { 4294967291ULL, 4294967291ULL } },                  // Just below 2^64.
+          { 4294967279ULL * 4294967291ULL, { 4294967279ULL, 4294967291ULL } },
+          { 1000000007ULL * 1000000009ULL, { 1000000007ULL, 1000000009ULL } },
+          { 2147483647ULL * 2147483647ULL * 2, { 2, 2147483647ULL, 2147483647ULL } },
+          { 999999000001ULL * 999983ULL, { 999983ULL, 999999000001ULL } },
+          { 1000003ULL * 1000033ULL * 1000037ULL, { 1000003ULL, 1000033ULL, 1000037ULL } },
+          { 1ULL << 63, std::list<u64>(63, 2) },
+          { 18446744073709551615ULL, { 3, 5, 17, 257, 641, 65537, 6700417 } },                   // 2^64 - 1.
+          { 3215031751ULL, { 151, 751, 28351 } }, // A strong pseudoprime to bases 2, 3, 5 and 7.
+          { 561, { 3, 11, 17 } },                 // A Carmichael number.
+      };
+      for (u64 p : largePrimes) known.push_back({ p, { p } });
+      for (u64 p : largePrimes)
+      {
+          if (p < (1ULL << 40)) known.push_back({ p * 8191, { std::min<u64>(p, 8191), std::max<u64>(p, 8191) } });
+      }
+      return known;
+  }
+
+  // Numbers up to about 10^12 with a mix of small and large factors, the same on every run.
+  std::vector<u64> mediumNumbers(unsigned int count)
+  {
+      std::vector<u64> numbers;
+      u64 state = 12345;
+      for (unsigned int i = 0; i < count; ++i)
+      {
+          state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+          numbers.push_back((state >> 24) % 1000000000000ULL);
+      }
+      return numbers;
+  }
+
+  // Every kind of input at once: the small numbers, the medium numbers and the known factorisations.
+  std::vector<u64> allInputs()
+  {
+      std::vector<u64> inputs = mediumNumbers(2000);
+      for (u64 x = 0; x < 5000; ++x) inputs.push_back(x);
+      for (const KnownFactorisation & known : knownFactorisations()) inputs.push_back(known.x);
+      return inputs;
+  }
+
+  // The factors as primeFactorisation(x) lists them, with each prime repeated "exponent" times.
+  std::list<u64> expanded(const PrimeFactors & factors)
+  {
+      std::list<u64> list;
+      for (const PrimeFactors::PrimePower & power : factors) list.insert(list.end(), power.exponent, power.prime);
+      return list;
+  }
+}
+
+using namespace PrimeFactorisation_N0731739;
+
+BOOST_AUTO_TEST_SUITE( primeFactorisation_engine_N0731739 )
+
+// Miller-Rabin agrees with trial division on every number below 10^5 and on the medium numbers.
+BOOST_AUTO_TEST_CASE( IsPrimeSameAsTrialDivision )
+{
+    for (u64 n = 0; n < 100000; ++n)
+    {
+        BOOST_CHECK_EQUAL( isPrime(n), n > 1 && trialDivision(n).size() == 1 );
+    }
+    for (u64 n : mediumNumbers(2000))
+    {
+        BOOST_CHECK_EQUAL( isPrime(n), n > 1 && trialDivision(n).size() == 1 );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( IsPrimeLarge )
+{
+    for (const KnownFactorisation & known : knownFactorisations())
+    {
+        BOOST_CHECK_EQUAL( isPrime(known.x), known.factors.size() == 1 );
+    }
+}
+
+// Pollard's rho finds a proper factor of each odd composite.
+BOOST_AUTO_TEST_CASE( FindFactor )
+{
+    for (const KnownFactorisation & known : knownFactorisations())
+    {
+        if (known.x % 2 == 0 || known.factors.size() < 2) continue;
+        const u64 factor = findFactor(known.x);
+        BOOST_CHECK( factor > 1 && factor < known.x );
+        BOOST_CHECK_EQUAL( known.x % factor, 0 );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( FactoriseLarge )
+{
+    for (const KnownFactorisation & known : knownFactorisations())
+    {
+        if (known.x < 2) continue;
+        u64 factors[maxPrimeFactors];
+        const unsigned int count = factoriseLarge(known.x, factors);
+        std::sort(factors, factors + count);
+        BOOST_CHECK_EQUAL_COLLECTIONS( factors, factors + count, known.factors.begin(), known.factors.end() );
+
+        std::list<u64> listed;
+        factoriseLarge(known.x, listed);
+        listed.sort();
+        BOOST_CHECK_EQUAL_COLLECTIONS( listed.begin(), listed.end(), known.factors.begin(), known.factors.end() );
+    }
+}
+
+// primeFactorisation() gives what trial division gives, and the known factors of the large inputs.
+BOOST_AUTO_TEST_CASE( SameAsTrialDivision )
+{
+    for (u64 x = 0; x < 20000; ++x)
+    {
+        const std::list<u64> expected = trialDivision(x), factors = primeFactorisation(x);
+        BOOST_CHECK_EQUAL_COLLECTIONS( factors.begin(), factors.end(), expected.begin(), expected.end() );
+    }
+    for (u64 x : mediumNumbers(2000))
+    {
+        const std::list<u64> expected = trialDivision(x), factors = primeFactorisation(x);
+        BOOST_CHECK_EQUAL_COLLECTIONS( factors.begin(), factors.end(), expected.begin(), expected.end() );
+    }
+    for (const KnownFactorisation & known : knownFactorisations())
+    {
+        const std::list<u64> factors = primeFactorisation(known.x);
+        BOOST_CHECK_EQUAL_COLLECTIONS( factors.begin(), factors.end(), known.factors.begin(), known.factors.end() );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE( primeFactorisation_batch_N0731739 )
+
+BOOST_AUTO_TEST_CASE( PrimeTablePrimes )
+{
+    const u64 limit = 100000;
+    std::vector<bool> composite(limit, false);
+    std::vector<u64> expected;
+    for (u64 n = 2; n < limit; ++n)
+    {
+        if (composite[n]) continue;
+        expected.push_back(n);
+        for (u64 m = n * n; m < limit; m += n) composite[m] = true;
+    }
+
+    const PrimeTable primes(limit);
+    BOOST_REQUIRE_EQUAL( primes.size(), expected.size() );
+    for (std::size_t i = 0; i < expected.size(); ++i) BOOST_CHECK_EQUAL( primes.prime(i), expected[i] );
+
+    BOOST_CHECK_EQUAL( PrimeTable(2).size(), 0 );
+    BOOST_CHECK_EQUAL( PrimeTable(3).size(), 1 );
+    BOOST_CHECK( sharedPrimeTable().size() > 0 );
+}
+
+// The multiplicative divisibility test and quotient agree with % and /, right up to 2^64 - 1.
+BOOST_AUTO_TEST_CASE( DividesAndExactQuotient )
+{
+    const PrimeTable & primes = sharedPrimeTable();
+    std::vector<u64> inputs = allInputs();
+    inputs.push_back(18446744073709551615ULL);
+    for (std::size_t i = 1; i < primes.size(); ++i)
+    {
+        const u64 p = primes.prime(i);
+        inputs.push_back(p * (18446744073709551615ULL / p));
+    }
+
+    for (std::size_t i = 1; i < primes.size(); i += 7)
+    {
+        const u64 p = primes.prime(i);
+        for (u64 x : inputs)
+        {
+            BOOST_CHECK_EQUAL( primes.divides(i, x), x % p == 0 );
+            if (x % p == 0) BOOST_CHECK_EQUAL( primes.exactQuotient(i, x), x / p );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( FactoriseInto )
+{
+    // With only 2 to trial-divide by, Pollard's rho finds every odd factor; with primes up to 10^6, trial division finds most.
+    const PrimeTable onlyTwo(3), upToAMillion(1000000);
+    for (const PrimeTable * primes : { & sharedPrimeTable(), & onlyTwo, & upToAMillion })
+    {
+        for (u64 x : allInputs())
+        {
+            u64 factors[maxPrimeFactors];
+            const unsigned int count = factoriseInto(x, *primes, factors);
+            const std::list<u64> expected = primeFactorisation(x);
+            BOOST_CHECK_EQUAL_COLLECTIONS( factors, factors + count, expected.begin(), expected.end() );
+        }
+    }
+}
+
+// On any number of threads, the batch holds the factors primeFactorisation() gives for each input, in order.
+BOOST_AUTO_TEST_CASE( BatchSameAsPrimeFactorisation )
+{
+    const std::vector<u64> inputs = allInputs();
+    for (unsigned int threads : { 0, 1, 2, 3, 8 })
+    {
+        const FactorBatch batch = primeFactorisationBatch(inputs, threads);
+        BOOST_REQUIRE_EQUAL( batch.size(), inputs.size() );
+        for (std::size_t i = 0; i < inputs.size(); ++i)
+        {
+            const std::list<u64> expected = primeFactorisation(inputs[i]);
+            BOOST_CHECK_EQUAL( batch.numFactors(i), expected.size() );
+            BOOST_CHECK_EQUAL_COLLECTIONS( batch.begin(i), batch.end(i), expected.begin(), expected.end() );
+        }
+    }
+
+    BOOST_CHECK_EQUAL( primeFactorisationBatch(std::vector<u64>(), 4).size(), 0 );
+    const u64 single[] = { 3037000453ULL * 3037000493ULL };
+    const FactorBatch one = primeFactorisationBatch(single, 1, 4);
+    BOOST_REQUIRE_EQUAL( one.size(), 1 );
+    BOOST_CHECK_EQUAL( one.numFactors(0), 2 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE( primeFactorisation_PrimeFactors_N0731739 )
+
+// The overload that fills a PrimeFactors gives the same factors as the list version, as prime powers.
+BOOST_AUTO_TEST_CASE( SameAsList )
+{
+    PrimeFactors factors;
+    for (u64 x : allInputs())
+    {
+        primeFactorisation(x, factors);
+        const std::list<u64> expected = primeFactorisation(x), list = expanded(factors);
+        BOOST_CHECK_EQUAL_COLLECTIONS( list.begin(), list.end(), expected.begin(), expected.end() );
+        BOOST_CHECK_EQUAL( factors.numFactors(), expected.size() );
+        for (unsigned int i = 1; i < factors.size(); ++i) BOOST_CHECK( factors[i - 1].prime < factors[i].prime );
+    }
+}
+
+// The previous contents are replaced, not added to.
+BOOST_AUTO_TEST_CASE( Reused )
+{
+    PrimeFactors factors;
+    primeFactorisation(4294967291ULL * 4294967291ULL, factors);
+    BOOST_REQUIRE_EQUAL( factors.size(), 1 );
+    BOOST_CHECK_EQUAL( factors[0].prime, 4294967291ULL );
+    BOOST_CHECK_EQUAL( factors[0].exponent, 2 );
+
+    for (u64 x : { 0, 1 })
+    {
+        primeFactorisation(x, factors);
+        BOOST_CHECK( factors.empty() );
+        BOOST_CHECK_EQUAL( factors.numFactors(), 0 );
+    }
+
+    primeFactorisation(2, factors);
+    BOOST_REQUIRE_EQUAL( factors.size(), 1 );
+    BOOST_CHECK_EQUAL( factors[0].prime, 2 );
+    BOOST_CHECK_EQUAL( factors[0].exponent, 1 );
+}
+
+// The product of the first 15 primes has as many distinct prime factors as a 64-bit number can.
+BOOST_AUTO_TEST_CASE( MostDistinctPrimes )
+{
+    const u64 primorial = 2ULL * 3 * 5 * 7 * 11 * 13 * 17 * 19 * 23 * 29 * 31 * 37 * 41 * 43 * 47;
+    PrimeFactors factors;
+    primeFactorisation(primorial, factors);
+    BOOST_CHECK_EQUAL( factors.size(), PrimeFactors::maxDistinct );
+    BOOST_CHECK_EQUAL( factors.numFactors(), PrimeFactors::maxDistinct );
+    BOOST_CHECK_EQUAL( factors[PrimeFactors::maxDistinct - 1].prime, 47 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE( primeFactorisation_SPFCache_N0731739 )
+
+const u64 cacheBound = 1 << 22;
+const std::string cacheFile = "spfCache_N0731739.spf";
+
+// The smallest prime factor of every number below "bound", by the sieve of Eratosthenes.
+std::vector<u64> smallestFactors(u64 bound)
+{
+    std::vector<u64> smallest(bound, 0);
+    for (u64 n = 2; n < bound; ++n)
+    {
+        if (smallest[n] != 0) continue;
+        for (u64 m = n; m < bound; m += n)
+        {
+            if (smallest[m] == 0) smallest[m] = n;
+        }
+    }
+    return smallest;
+}
+
+// The number of x in [2, bound) for which the cache gives a smallest factor other than the sieve's.
+std::size_t numWrong(const SPFCache & cache, const std::vector<u64> & smallest)
+{
+    std::size_t wrong = 0;
+    for (u64 x = 2; x < cache.bound(); ++x)
+    {
+        if (cache.smallestFactor(x) != smallest[x]) ++wrong;
+    }
+    return wrong;
+}
+
+// The cache is the same whatever the number of threads that sieve it, including bounds that are not a whole number of segments.
+BOOST_AUTO_TEST_CASE( SmallestFactor )
+{
+    const std::vector<u64> smallest = smallestFactors(cacheBound);
+    for (unsigned int threads : { 1, 2, 3, 0 })
+    {
+        const SPFCache cache(cacheBound, threads);
+        BOOST_CHECK_EQUAL( cache.bound(), cacheBound );
+        BOOST_CHECK_EQUAL( numWrong(cache, smallest), 0 );
+    }
+    for (u64 bound : { 0, 1, 2, 3, 10, 32769, 100003 })
+    {
+        const SPFCache cache(bound, 4);
+        BOOST_CHECK_EQUAL( cache.bound(), bound );
+        BOOST_CHECK_EQUAL( numWrong(cache, smallest), 0 );
+        BOOST_CHECK( ! cache.covers(bound) );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( Factorise )
+{
+    const SPFCache cache(cacheBound, 4);
+    PrimeFactors factors;
+    std::vector<u64> inputs = { 0, 1, 2, 3, 4, 8191, 4194301, cacheBound - 1, cacheBound - 3 };
+    for (u64 x : mediumNumbers(5000)) inputs.push_back(x % cacheBound);
+    for (u64 x = 0; x < 5000; ++x) inputs.push_back(x);
+    for (u64 x : inputs)
+    {
+        cache.factorise(x, factors);
+        const std::list<u64> expected = trialDivision(x), list = expanded(factors);
+        BOOST_CHECK_EQUAL_COLLECTIONS( list.begin(), list.end(), expected.begin(), expected.end() );
+    }
+}
+
+// With the cache in use, primeFactorisation() looks up the numbers it covers and factorises the rest as before.
+BOOST_AUTO_TEST_CASE( UseSPFCache )
+{
+    const std::vector<u64> inputs = allInputs();
+    std::vector<std::list<u64>> expected;
+    for (u64 x : inputs) expected.push_back(primeFactorisation(x));
+
+    const SPFCache cache(cacheBound, 4);
+    BOOST_CHECK( activeSPFCache() == nullptr );
+    useSPFCache(& cache);
+    BOOST_CHECK( activeSPFCache() == & cache );
+    for (std::size_t i = 0; i < inputs.size(); ++i)
+    {
+        const std::list<u64> factors = primeFactorisation(inputs[i]);
+        BOOST_CHECK_EQUAL_COLLECTIONS( factors.begin(), factors.end(), expected[i].begin(), expected[i].end() );
+        PrimeFactors powers;
+        primeFactorisation(inputs[i], powers);
+        const std::list<u64> list = expanded(powers);
+        BOOST_CHECK_EQUAL_COLLECTIONS( list.begin(), list.end(), expected[i].begin(), expected[i].end() );
+    }
+    useSPFCache(nullptr);
+    BOOST_CHECK( activeSPFCache() == nullptr );
+}
+
+// A saved cache loads with the same bound and factors.
+BOOST_AUTO_TEST_CASE( SaveAndLoad )
+{
+    const std::vector<u64> smallest = smallestFactors(cacheBound);
+    SPFCache(cacheBound, 4).save(cacheFile);
+    {
+        const SPFCache loaded(cacheFile);
+        BOOST_CHECK_EQUAL( loaded.bound(), cacheBound );
+        BOOST_CHECK_EQUAL( numWrong(loaded, smallest), 0 );
+    }
+    std::remove(cacheFile.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( Errors )
+{
+    BOOST_CHECK_THROW( SPFCache(SPFCache::maxBound + 1), std::invalid_argument );
+    BOOST_CHECK_THROW( SPFCache("spfCache_N0731739.missing"), std::invalid_argument );
+
+    std::ofstream(cacheFile) << "Not an SPF cache file, but long enough to hold a header.";
+    BOOST_CHECK_THROW( SPFCache{cacheFile}, std::domain_error );
+
+    std::ofstream(cacheFile) << "Short";
+    BOOST_CHECK_THROW( SPFCache{cacheFile}, std::domain_error );
+
+    // A valid header, but with the table cut short.
+    SPFCache(1000).save(cacheFile);
+    std::string contents;
+    {
+        std::ifstream file(cacheFile, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    std::ofstream(cacheFile, std::ios::binary) << contents.substr(0, contents.size() - 2);
+    BOOST_CHECK_THROW( SPFCache{cacheFile}, std::domain_error );
+
+    std::remove(cacheFile.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
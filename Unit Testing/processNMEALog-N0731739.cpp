@@ -0,0 +1,140 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <stdexcept>
+
+#include "nmeaFields.h"
+#include "nmeaLog.h"
+#include "parallelfor.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+BOOST_AUTO_TEST_SUITE( NMEA_processNMEALog_N0731739 )
+
+// About 6MB, so that the log is split into several chunks.
+const std::size_t logSize = 6 << 20;
+
+// The log with some malformed sentences: one without a '*', one with a non-hexadecimal checksum.
+std::string damagedLog()
+{
+    std::string log = GeneratedLogs::nmeaLog(logSize);
+    const std::size_t first = log.find("*", log.size() / 3);
+    log.erase(first, 3);
+    const std::size_t second = log.find("*", 2 * log.size() / 3);
+    log[second + 1] = 'Z';
+    return log;
+}
+
+// Any number of threads gives the same sentences, fields and failures as one.
+BOOST_AUTO_TEST_CASE( SameOnAnyNumberOfThreads )
+{
+    const std::string log = damagedLog();
+    const NMEALogContents serial = processNMEALog(TextView(log), 1);
+    BOOST_REQUIRE( serial.sentences.size() > 50000 );
+
+    for (unsigned int threads : { 0, 2, 3, 8, 32 })
+    {
+        const NMEALogContents threaded = processNMEALog(TextView(log), threads);
+
+        BOOST_REQUIRE_EQUAL( threaded.sentences.size(), serial.sentences.size() );
+        BOOST_REQUIRE_EQUAL( threaded.fields.size(), serial.fields.size() );
+        for (std::size_t i = 0; i < serial.sentences.size(); ++i)
+        {
+            const NMEASentence & expected = serial.sentences[i];
+            const NMEASentence & sentence = threaded.sentences[i];
+            if (sentence.offset != expected.offset || sentence.numFields != expected.numFields
+                || sentence.type.first != expected.type.first || sentence.firstField != expected.firstField)
+            {
+                BOOST_ERROR( "Sentence " << i << " differs." );
+                break;
+            }
+        }
+        for (std::size_t f = 0; f < serial.fields.size(); ++f)
+        {
+            if (threaded.fields[f].first != serial.fields[f].first || threaded.fields[f].last != serial.fields[f].last)
+            {
+                BOOST_ERROR( "Field " << f << " differs." );
+                break;
+            }
+        }
+        BOOST_REQUIRE_EQUAL( threaded.failures.size(), serial.failures.size() );
+        for (std::size_t i = 0; i < serial.failures.size(); ++i)
+        {
+            BOOST_CHECK_EQUAL( threaded.failures[i].offset, serial.failures[i].offset );
+            BOOST_CHECK( threaded.failures[i].fault == serial.failures[i].fault );
+        }
+    }
+}
+
+// Every sentence is either valid and decomposed, or reported at its offset with the reason.
+BOOST_AUTO_TEST_CASE( EverySentenceAccountedFor )
+{
+    const std::string log = damagedLog();
+    const NMEALogContents contents = processNMEALog(TextView(log), 4);
+
+    std::size_t numSentences = 0;
+    for (std::size_t pos = log.find('$'); pos != std::string::npos; pos = log.find('$', pos + 1)) ++numSentences;
+    BOOST_CHECK_EQUAL( contents.sentences.size() + contents.failures.size(), numSentences );
+
+    std::size_t faults[3] = { 0, 0, 0 };
+    for (const NMEAFailure & failure : contents.failures)
+    {
+        BOOST_REQUIRE_EQUAL( log[failure.offset], '$' );
+        ++faults[(int)failure.fault];
+    }
+    BOOST_CHECK_EQUAL( faults[(int)NMEAFault::NoChecksum], 1 );
+    BOOST_CHECK_EQUAL( faults[(int)NMEAFault::NonHexChecksum], 1 );
+    BOOST_CHECK( faults[(int)NMEAFault::WrongChecksum] > 0 ); // One GGA in fifty.
+
+    for (std::size_t i = 0; i < contents.sentences.size(); i += 997)
+    {
+        const NMEASentence & sentence = contents.sentences[i];
+        const std::size_t end = log.find('\n', sentence.offset);
+        const std::string text = log.substr(sentence.offset, end - 1 - sentence.offset);
+        BOOST_CHECK( isValidSentence(TextView(text)) );
+
+        NMEAFields expected;
+        BOOST_REQUIRE( decomposeSentence(TextView(text), expected) );
+        BOOST_CHECK_EQUAL( sentence.type.str(), expected.type.str() );
+        BOOST_REQUIRE_EQUAL( sentence.numFields, expected.numFields );
+        for (std::size_t f = 0; f < expected.numFields; ++f)
+        {
+            BOOST_CHECK_EQUAL( contents.field(sentence, f).str(), expected.fields[f].str() );
+        }
+    }
+}
+
+// parallelFor() calls the body exactly once for each index, whatever the number of threads.
+BOOST_AUTO_TEST_CASE( ParallelForVisitsEachIndexOnce )
+{
+    for (unsigned int threads : { 0, 1, 2, 7, 64 })
+    {
+        for (std::size_t count : { 0, 1, 5, 1000 })
+        {
+            std::vector<std::atomic<int>> calls(count);
+            for (std::atomic<int> & c : calls) c = 0;
+            parallelFor(count, threads, [&](std::size_t i) { ++calls[i]; });
+            for (std::size_t i = 0; i < count; ++i) BOOST_CHECK_EQUAL( calls[i].load(), 1 );
+        }
+    }
+}
+
+// An exception thrown by the body stops the claiming of indices, and is rethrown on the calling thread.
+BOOST_AUTO_TEST_CASE( ParallelForRethrows )
+{
+    for (unsigned int threads : { 1, 4 })
+    {
+        std::atomic<std::size_t> numCalls(0);
+        BOOST_CHECK_THROW( parallelFor(100000, threads, [&](std::size_t i)
+        {
+            ++numCalls;
+            if (i == 10) throw std::domain_error("Index 10.");
+        }), std::domain_error );
+        BOOST_CHECK( numCalls < 100000 );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
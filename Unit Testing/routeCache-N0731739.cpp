@@ -0,0 +1,180 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <stdexcept>
+#include <utime.h>
+#include <sys/stat.h>
+
+#include "logs.h"
+#include "types.h"
+#include "route.h"
+#include "track.h"
+#include "routecache.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+BOOST_AUTO_TEST_SUITE( RouteCache_N0731739 )
+
+const bool isFileName = true;
+const std::string cacheFile = LogFiles::LogsDir + "routeCache_N0731739.cache";
+
+ParseOptions withStorage(PositionStorage storage)
+{
+    ParseOptions options;
+    options.storage = storage;
+    return options;
+}
+
+const PositionStorage storages[] = { PositionStorage::Objects, PositionStorage::Arrays };
+
+struct NamedWalk
+{
+    std::vector<Position> points;
+    std::vector<seconds> times;
+    std::vector<std::string> names;
+
+    NamedWalk()
+    {
+        points = GeneratedLogs::randomWalk(500, 14);
+        seconds time = 0;
+        for (unsigned int i = 0; i < points.size(); ++i)
+        {
+            time += (i % 7 == 0) ? 65 : 5;
+            times.push_back(time);
+            names.push_back(i % 5 == 0 ? "P" + std::to_string(i % 45) : "");
+        }
+    }
+};
+
+std::string writeLogFile(const std::string & filePath, const std::string & contents)
+{
+    std::ofstream file(filePath);
+    file << contents;
+    file.close();
+    return filePath;
+}
+
+void checkSameRoute(const Route & loaded, const Route & original)
+{
+    BOOST_CHECK_EQUAL( loaded.name(), original.name() );
+    BOOST_CHECK_EQUAL( loaded.buildReport(), original.buildReport() );
+    BOOST_REQUIRE_EQUAL( loaded.numPositions(), original.numPositions() );
+    for (unsigned int i = 0; i < original.numPositions(); ++i)
+    {
+        BOOST_CHECK_EQUAL( loaded[i].latitude(), original[i].latitude() );
+        BOOST_CHECK_EQUAL( loaded[i].longitude(), original[i].longitude() );
+        BOOST_CHECK_EQUAL( loaded[i].elevation(), original[i].elevation() );
+        BOOST_CHECK_EQUAL( loaded.findNameOf(loaded[i]), original.findNameOf(original[i]) );
+        BOOST_CHECK_EQUAL( loaded.timesVisited(loaded[i]), original.timesVisited(original[i]) );
+    }
+    BOOST_CHECK_EQUAL( loaded.totalLength(), original.totalLength() );
+    BOOST_CHECK_EQUAL( loaded.netLength(), original.netLength() );
+    BOOST_CHECK_EQUAL( loaded.totalHeightGain(), original.totalHeightGain() );
+    BOOST_CHECK_EQUAL( loaded.maxGradient(), original.maxGradient() );
+    BOOST_CHECK_EQUAL( loaded.minLatitude(), original.minLatitude() );
+    BOOST_CHECK_EQUAL( loaded.maxElevation(), original.maxElevation() );
+}
+
+// A Route is reloaded as it was saved, with either storage.
+BOOST_AUTO_TEST_CASE( RouteRoundTrip )
+{
+    const NamedWalk walk;
+    for (PositionStorage storage : storages)
+    {
+        const Route route(GeneratedLogs::routeGPX(walk.points, walk.names), ! isFileName, 15, withStorage(storage));
+        RouteCache::save(route, cacheFile);
+
+        std::unique_ptr<Route> loaded = RouteCache::loadRoute(cacheFile);
+        BOOST_CHECK( dynamic_cast<Track *>(loaded.get()) == nullptr );
+        checkSameRoute(*loaded, route);
+        BOOST_CHECK_THROW( RouteCache::loadTrack(cacheFile), std::domain_error );
+    }
+}
+
+// A Track is reloaded as a Track, with its times.
+BOOST_AUTO_TEST_CASE( TrackRoundTrip )
+{
+    const NamedWalk walk;
+    for (PositionStorage storage : storages)
+    {
+        const Track track(GeneratedLogs::trackGPX(walk.points, walk.times, walk.names), ! isFileName, 15, withStorage(storage));
+        RouteCache::save(track, cacheFile);
+
+        std::unique_ptr<Track> loaded = RouteCache::loadTrack(cacheFile);
+        checkSameRoute(*loaded, track);
+        BOOST_CHECK_EQUAL( loaded->totalTime(), track.totalTime() );
+        BOOST_CHECK_EQUAL( loaded->restingTime(), track.restingTime() );
+        BOOST_CHECK_EQUAL( loaded->maxSpeed(), track.maxSpeed() );
+        BOOST_CHECK_EQUAL( loaded->maxRateOfAscent(), track.maxRateOfAscent() );
+    }
+}
+
+// The granularity of a reloaded Route can still be changed.
+BOOST_AUTO_TEST_CASE( SetGranularityAfterLoading )
+{
+    const NamedWalk walk;
+    const std::string gpx = GeneratedLogs::routeGPX(walk.points, walk.names);
+    RouteCache::save(Route(gpx, ! isFileName, 15), cacheFile);
+
+    std::unique_ptr<Route> loaded = RouteCache::loadRoute(cacheFile);
+    loaded->setGranularity(40);
+    Route changed(gpx, ! isFileName, 15);
+    changed.setGranularity(40);
+    checkSameRoute(*loaded, changed);
+}
+
+// A cache is only used while the GPX file it was saved from is unchanged.
+BOOST_AUTO_TEST_CASE( StaleSource )
+{
+    const NamedWalk walk;
+    const std::string sourceFile = writeLogFile(LogFiles::GPXRoutesDir + "routeCache_N0731739.gpx",
+                                                GeneratedLogs::routeGPX(walk.points, walk.names));
+    RouteCache::save(Route(sourceFile, isFileName), cacheFile, sourceFile);
+    BOOST_CHECK_NO_THROW( RouteCache::loadRoute(cacheFile, sourceFile) );
+
+    // Touched, but the same size.
+    struct stat info;
+    BOOST_REQUIRE( ::stat(sourceFile.c_str(), &info) == 0 );
+    struct utimbuf times = { info.st_atime, info.st_mtime + 1 };
+    BOOST_REQUIRE( ::utime(sourceFile.c_str(), &times) == 0 );
+    BOOST_CHECK_THROW( RouteCache::loadRoute(cacheFile, sourceFile), std::domain_error );
+    BOOST_CHECK_NO_THROW( RouteCache::loadRoute(cacheFile) );
+
+    // Rewritten with different points.
+    RouteCache::save(Route(sourceFile, isFileName), cacheFile, sourceFile);
+    writeLogFile(sourceFile, GeneratedLogs::routeGPX(GeneratedLogs::randomWalk(400, 15)));
+    BOOST_CHECK_THROW( RouteCache::loadRoute(cacheFile, sourceFile), std::domain_error );
+
+    // Saved without naming the source, so it cannot be checked against it.
+    RouteCache::save(Route(sourceFile, isFileName), cacheFile);
+    BOOST_CHECK_THROW( RouteCache::loadRoute(cacheFile, sourceFile), std::domain_error );
+
+    BOOST_CHECK_THROW( RouteCache::save(Route(sourceFile, isFileName), cacheFile, sourceFile + ".missing"), std::invalid_argument );
+}
+
+// Any damage to the file is detected, whether in the header or the payload.
+BOOST_AUTO_TEST_CASE( CorruptFile )
+{
+    const NamedWalk walk;
+    RouteCache::save(Track(GeneratedLogs::trackGPX(walk.points, walk.times, walk.names), ! isFileName, 15), cacheFile);
+
+    std::string contents;
+    {
+        std::ifstream file(cacheFile, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    for (std::size_t pos = 8; pos < contents.size(); pos += contents.size() / 97)
+    {
+        std::string damaged = contents;
+        damaged[pos] ^= 0x10;
+        writeLogFile(cacheFile, damaged);
+        BOOST_CHECK_THROW( RouteCache::loadRoute(cacheFile), std::domain_error );
+    }
+    writeLogFile(cacheFile, contents.substr(0, contents.size() - 8));
+    BOOST_CHECK_THROW( RouteCache::loadRoute(cacheFile), std::domain_error );
+
+    BOOST_CHECK_THROW( RouteCache::loadRoute(cacheFile + ".missing"), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
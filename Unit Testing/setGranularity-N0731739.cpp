@@ -0,0 +1,145 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+
+#include "logs.h"
+#include "types.h"
+#include "geometry.h"
+#include "route.h"
+#include "track.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+// Checks that two Routes hold the same points, names and summary values.
+void checkSameRoute(const Route & changed, const Route & constructed)
+{
+    BOOST_REQUIRE_EQUAL( changed.numPositions(), constructed.numPositions() );
+    for (unsigned int i = 0; i < changed.numPositions(); ++i)
+    {
+        BOOST_CHECK_EQUAL( changed[i].latitude(), constructed[i].latitude() );
+        BOOST_CHECK_EQUAL( changed[i].longitude(), constructed[i].longitude() );
+        BOOST_CHECK_EQUAL( changed.findNameOf(changed[i]), constructed.findNameOf(constructed[i]) );
+    }
+    BOOST_CHECK_EQUAL( changed.totalLength(), constructed.totalLength() );
+    BOOST_CHECK_EQUAL( changed.totalHeightGain(), constructed.totalHeightGain() );
+    BOOST_CHECK_EQUAL( changed.maxGradient(), constructed.maxGradient() );
+}
+
+BOOST_AUTO_TEST_SUITE( Route_setGranularity_N0731739 )
+
+const bool isFileName = true;
+const metres horizontalGridUnit = 30000;
+
+// Coarsening discards the points that a Route constructed at that granularity would discard.
+BOOST_AUTO_TEST_CASE( CoarserGranularity )
+{
+    const metres granularity = horizontalGridUnit * 1.01;
+    Route changed = Route(LogFiles::GPXRoutesDir + "ABCD.gpx", isFileName);
+    changed.setGranularity(granularity);
+    checkSameRoute(changed, Route(LogFiles::GPXRoutesDir + "ABCD.gpx", isFileName, granularity));
+}
+
+// Refining restores points that an earlier, coarser granularity discarded.
+BOOST_AUTO_TEST_CASE( FinerGranularityRestoresPoints )
+{
+    Route changed = Route(LogFiles::GPXRoutesDir + "ABCD.gpx", isFileName, horizontalGridUnit * 1.01);
+    changed.setGranularity(20);
+    checkSameRoute(changed, Route(LogFiles::GPXRoutesDir + "ABCD.gpx", isFileName, 20));
+}
+
+// A Track also rebuilds its arrival and departure times.
+BOOST_AUTO_TEST_CASE( TrackTimes )
+{
+    const metres granularity = horizontalGridUnit * 1.01;
+    Track changed = Track(LogFiles::GPXTracksDir + "A1B3C.gpx", isFileName);
+    changed.setGranularity(granularity);
+    Track constructed = Track(LogFiles::GPXTracksDir + "A1B3C.gpx", isFileName, granularity);
+
+    checkSameRoute(changed, constructed);
+    BOOST_CHECK_EQUAL( changed.totalTime(), constructed.totalTime() );
+    BOOST_CHECK_EQUAL( changed.restingTime(), constructed.restingTime() );
+    BOOST_CHECK_EQUAL( changed.maxSpeed(), constructed.maxSpeed() );
+}
+
+/* The point "distance" metres from "from", as measured by Position::distanceBetween(), heading
+ * on "bearing"; found by bisecting the angle at the centre of the Earth.
+ */
+Position pointAt(const Position & from, radians bearing, metres distance)
+{
+    const radians lat1 = degToRad(from.latitude()), lon1 = degToRad(from.longitude());
+    auto destination = [&](radians angle)
+    {
+        radians lat2 = std::asin(std::sin(lat1) * std::cos(angle) + std::cos(lat1) * std::sin(angle) * std::cos(bearing));
+        radians lon2 = lon1 + std::atan2(std::sin(bearing) * std::sin(angle) * std::cos(lat1),
+                                         std::cos(angle) - std::sin(lat1) * std::sin(lat2));
+        degrees lon = std::remainder(radToDeg(lon2), fullRotation);
+        return Position(radToDeg(lat2), lon, 0);
+    };
+
+    radians low = 0, high = 1.5;
+    for (int i = 0; i < 200; ++i)
+    {
+        radians middle = (low + high) / 2;
+        if (Position::distanceBetween(from, destination(middle)) < distance) low = middle;
+        else high = middle;
+    }
+    return destination(high);
+}
+
+/* Points each within a hair's breadth of "granularity" of the last point that a linear scan
+ * with Position::distanceBetween() keeps, so that rounding in any faster comparison shows up.
+ * The points such a scan keeps are stored in "kept".
+ */
+std::vector<Position> pointsNearBoundary(metres granularity, std::vector<Position> & kept)
+{
+    const double offsets[] = { 0, 1e-12, -1e-12, 1e-10, -1e-10, 1e-9, -1e-9, 3e-8, -3e-8, 1e-7, -1e-7, 1e-6, -1e-6 };
+    const unsigned int numOffsets = sizeof(offsets) / sizeof(offsets[0]);
+
+    std::vector<Position> points = { Position(10, 20, 0) };
+    kept = points;
+    for (unsigned int i = 1; i < 400; ++i)
+    {
+        Position next = pointAt(kept.back(), i * 0.7, granularity * (1 + offsets[i % numOffsets]));
+        points.push_back(next);
+        if (Position::distanceBetween(next, kept.back()) >= granularity) kept.push_back(next);
+    }
+    return points;
+}
+
+void checkKeptPoints(const Route & route, const std::vector<Position> & kept)
+{
+    BOOST_REQUIRE_EQUAL( route.numPositions(), kept.size() );
+    for (unsigned int i = 0; i < kept.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL( route[i].latitude(), kept[i].latitude() );
+        BOOST_CHECK_EQUAL( route[i].longitude(), kept[i].longitude() );
+    }
+}
+
+const metres boundaryGranularities[] = { 20, 5000, 250000, 999999, 3000000 };
+
+// Points at almost exactly the granularity are kept or discarded just as distanceBetween() decides.
+BOOST_AUTO_TEST_CASE( PointsNearGranularityAtConstruction )
+{
+    for (metres granularity : boundaryGranularities)
+    {
+        std::vector<Position> kept;
+        const std::vector<Position> points = pointsNearBoundary(granularity, kept);
+        checkKeptPoints(Route(GeneratedLogs::routeGPX(points), ! isFileName, granularity), kept);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( PointsNearGranularityAfterChange )
+{
+    for (metres granularity : boundaryGranularities)
+    {
+        std::vector<Position> kept;
+        const std::vector<Position> points = pointsNearBoundary(granularity, kept);
+        Route changed(GeneratedLogs::routeGPX(points), ! isFileName, 1);
+        changed.setGranularity(granularity);
+        checkKeptPoints(changed, kept);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,77 @@
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+
+#include "types.h"
+#include "track.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+BOOST_AUTO_TEST_SUITE( Track_threadedParse_N0731739 )
+
+const bool isFileName = true;
+const unsigned int numPoints = 30000; // About 3MB of GPX, enough to be split between threads.
+
+ParseOptions withThreads(unsigned int threads)
+{
+    ParseOptions options;
+    options.threads = threads;
+    return options;
+}
+
+std::string largeTrack()
+{
+    std::vector<Position> points = GeneratedLogs::randomWalk(numPoints, 11);
+    std::vector<seconds> times;
+    std::vector<std::string> names;
+    for (unsigned int i = 0; i < numPoints; ++i)
+    {
+        times.push_back(i * 2);
+        names.push_back(i % 97 == 0 ? "P" + std::to_string(i) : "");
+    }
+    return GeneratedLogs::trackGPX(points, times, names);
+}
+
+// Reading the points on several threads gives the same Track as reading them on one.
+BOOST_AUTO_TEST_CASE( SameTrackOnAnyNumberOfThreads )
+{
+    const std::string gpx = largeTrack();
+    const Track serial(gpx, ! isFileName, 10, withThreads(1));
+
+    for (unsigned int threads : { 2, 4, 16 })
+    {
+        const Track threaded(gpx, ! isFileName, 10, withThreads(threads));
+
+        BOOST_CHECK_EQUAL( threaded.buildReport(), serial.buildReport() );
+        BOOST_REQUIRE_EQUAL( threaded.numPositions(), serial.numPositions() );
+        for (unsigned int i = 0; i < serial.numPositions(); ++i)
+        {
+            BOOST_CHECK_EQUAL( threaded.findNameOf(threaded[i]), serial.findNameOf(serial[i]) );
+        }
+        BOOST_CHECK_EQUAL( threaded.totalLength(), serial.totalLength() );
+        BOOST_CHECK_EQUAL( threaded.totalTime(), serial.totalTime() );
+        BOOST_CHECK_EQUAL( threaded.restingTime(), serial.restingTime() );
+        BOOST_CHECK_EQUAL( threaded.maxSpeed(), serial.maxSpeed() );
+    }
+}
+
+// A point without a time near the end is reported as the serial parse would report it.
+BOOST_AUTO_TEST_CASE( ErrorInLaterChunk )
+{
+    std::string gpx = largeTrack();
+    const std::string lastTime = "<time>" + std::to_string((numPoints - 1) * 2) + "</time>";
+    gpx.erase(gpx.find(lastTime), lastTime.size());
+
+    BOOST_CHECK_THROW( Track(gpx, ! isFileName, 10, withThreads(4)), std::domain_error );
+    try
+    {
+        Track(gpx, ! isFileName, 10, withThreads(4));
+    }
+    catch (const std::domain_error & e)
+    {
+        BOOST_CHECK_EQUAL( std::string(e.what()), "No 'time' element." );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,127 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+
+#include "types.h"
+#include "route.h"
+#include "track.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+BOOST_AUTO_TEST_SUITE( Route_totalLength_N0731739 )
+
+const bool isFileName = true;
+
+// The length of a step between two points, counting the change in elevation.
+metres stepLength(const Position & from, const Position & to)
+{
+    metres deltaH = Position::distanceBetween(from, to);
+    metres deltaV = to.elevation() - from.elevation();
+    return std::sqrt(deltaH * deltaH + deltaV * deltaV);
+}
+
+BOOST_AUTO_TEST_CASE( SinglePoint )
+{
+    Route route(GeneratedLogs::routeGPX({ Position(52.9, -1.18, 40) }), ! isFileName);
+    BOOST_CHECK_EQUAL( route.totalLength(), 0 );
+}
+
+// On the level, the length is the sum of the horizontal distances.
+BOOST_AUTO_TEST_CASE( Level )
+{
+    const std::vector<Position> points = { Position(0, 0, 10), Position(0, 0.001, 10), Position(0, 0.003, 10) };
+    Route route(GeneratedLogs::routeGPX(points), ! isFileName);
+
+    const metres expected = Position::distanceBetween(points[0], points[1]) + Position::distanceBetween(points[1], points[2]);
+    BOOST_CHECK_CLOSE( route.totalLength(), expected, 1e-9 );
+}
+
+// A climb of 30m over about 111m is about 115m long, not 111m + 30^2.
+BOOST_AUTO_TEST_CASE( Climb )
+{
+    const std::vector<Position> points = { Position(0, 0, 0), Position(0, 0.001, 30) };
+    Route route(GeneratedLogs::routeGPX(points), ! isFileName);
+
+    BOOST_CHECK_CLOSE( route.totalLength(), stepLength(points[0], points[1]), 1e-9 );
+    BOOST_CHECK_CLOSE( route.totalLength(), 115.2, 0.1 );
+}
+
+// Climbs and descents alike add to the length.
+BOOST_AUTO_TEST_CASE( UpAndDown )
+{
+    const std::vector<Position> points = GeneratedLogs::randomWalk(200, 4);
+    Route route(GeneratedLogs::routeGPX(points), ! isFileName, 0);
+
+    metres expected = 0;
+    for (unsigned int i = 1; i < points.size(); ++i) expected += stepLength(points[i - 1], points[i]);
+    BOOST_CHECK_CLOSE( route.totalLength(), expected, 1e-9 );
+}
+
+// Points discarded for being too close contribute nothing; the kept points are joined directly.
+BOOST_AUTO_TEST_CASE( DiscardedPoints )
+{
+    const std::vector<Position> points = { Position(0, 0, 0), Position(0, 0.0001, 50), Position(0, 0.001, 30) };
+    Route route(GeneratedLogs::routeGPX(points), ! isFileName, 20);
+
+    BOOST_REQUIRE_EQUAL( route.numPositions(), 2 );
+    BOOST_CHECK_CLOSE( route.totalLength(), stepLength(points[0], points[2]), 1e-9 );
+}
+
+// A Track built point by point has the same length as one parsed from GPX.
+BOOST_AUTO_TEST_CASE( LiveTrack )
+{
+    const std::vector<Position> points = GeneratedLogs::randomWalk(300, 5);
+    std::vector<seconds> times;
+    Track live(10);
+    for (unsigned int i = 0; i < points.size(); ++i)
+    {
+        times.push_back(i);
+        live.append(points[i], i);
+    }
+    Track parsed(GeneratedLogs::trackGPX(points, times), ! isFileName, 10);
+
+    BOOST_CHECK_CLOSE( live.totalLength(), parsed.totalLength(), 1e-9 );
+}
+
+// The storage of the points makes no difference to any result: not even the last bit.
+BOOST_AUTO_TEST_CASE( ArraysSameAsObjects )
+{
+    const std::vector<Position> points = GeneratedLogs::randomWalk(3000, 6);
+    std::vector<seconds> times;
+    for (unsigned int i = 0; i < points.size(); ++i) times.push_back(5 * i);
+    const std::string routeGPX = GeneratedLogs::routeGPX(points), trackGPX = GeneratedLogs::trackGPX(points, times);
+
+    ParseOptions arrays;
+    arrays.storage = PositionStorage::Arrays;
+
+    for (metres granularity : { 0.0, 10.0, 35.0 })
+    {
+        Route objectsRoute(routeGPX, ! isFileName, granularity), arraysRoute(routeGPX, ! isFileName, granularity, arrays);
+        Track objectsTrack(trackGPX, ! isFileName, granularity), arraysTrack(trackGPX, ! isFileName, granularity, arrays);
+        Track liveTrack(granularity, arrays);
+        for (unsigned int i = 0; i < points.size(); ++i) liveTrack.append(points[i], times[i]);
+
+        for (const Route * route : std::initializer_list<const Route *>{ & arraysRoute, & arraysTrack, & liveTrack })
+        {
+            const Route & objects = (route == & arraysRoute) ? objectsRoute : objectsTrack;
+            BOOST_REQUIRE_EQUAL( route->numPositions(), objects.numPositions() );
+            BOOST_CHECK_EQUAL( route->totalLength(), objects.totalLength() );
+            BOOST_CHECK_EQUAL( route->netLength(), objects.netLength() );
+            BOOST_CHECK_EQUAL( route->totalHeightGain(), objects.totalHeightGain() );
+            BOOST_CHECK_EQUAL( route->maxGradient(), objects.maxGradient() );
+            BOOST_CHECK_EQUAL( route->minGradient(), objects.minGradient() );
+            BOOST_CHECK_EQUAL( route->minLatitude(), objects.minLatitude() );
+            BOOST_CHECK_EQUAL( route->maxLongitude(), objects.maxLongitude() );
+        }
+        BOOST_CHECK_EQUAL( arraysTrack.maxSpeed(), objectsTrack.maxSpeed() );
+        BOOST_CHECK_EQUAL( arraysTrack.averageSpeed(false), objectsTrack.averageSpeed(false) );
+
+        objectsRoute.setGranularity(granularity + 20);
+        arraysRoute.setGranularity(granularity + 20);
+        BOOST_CHECK_EQUAL( arraysRoute.totalLength(), objectsRoute.totalLength() );
+        BOOST_CHECK_EQUAL( arraysRoute.netLength(), objectsRoute.netLength() );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
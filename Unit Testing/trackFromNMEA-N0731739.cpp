@@ -0,0 +1,120 @@
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <stdexcept>
+
+#include "types.h"
+#include "track.h"
+#include "nmeaTrack.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+BOOST_AUTO_TEST_SUITE( Track_trackFromNMEA_N0731739 )
+
+// A GGA sentence at "time" (hhmmss) and "latitude" (ddmm.mmmm, North), 1 degree 08 minutes West.
+std::string gga(const std::string & time, const std::string & latitude, const std::string & elevation)
+{
+    return GeneratedLogs::withChecksum("GPGGA," + time + ".00," + latitude + ",N,00108.0000,W,1,08,0.9,"
+                                       + elevation + ",M,46.9,M,,");
+}
+
+// An RMC sentence, which has no elevation.
+std::string rmc(const std::string & time, const std::string & latitude)
+{
+    return GeneratedLogs::withChecksum("GPRMC," + time + ".00,A," + latitude + ",N,00108.0000,W,0.5,54.7,191194,020.3,E");
+}
+
+Track trackFrom(const std::string & log, metres granularity = 10)
+{
+    std::istringstream stream(log);
+    return trackFromNMEA(stream, granularity);
+}
+
+// 1 minute of latitude is about 1852m, so these points are well apart.
+const degrees north1 = 52 + 56.0 / 60, north2 = 52 + 57.0 / 60, north3 = 52 + 58.0 / 60;
+
+// An RMC sentence before the GGA sentence for the same time does not lose the GGA elevation.
+BOOST_AUTO_TEST_CASE( RMCBeforeGGA )
+{
+    const Track track = trackFrom(rmc("120000", "5256.0000") + gga("120000", "5256.0000", "100.0")
+                                + rmc("120010", "5257.0000") + gga("120010", "5257.0000", "120.0"));
+
+    BOOST_REQUIRE_EQUAL( track.numPositions(), 2 );
+    BOOST_CHECK_EQUAL( track[0].elevation(), 100 );
+    BOOST_CHECK_EQUAL( track[1].elevation(), 120 );
+    BOOST_CHECK_EQUAL( track.totalTime(), 10 );
+    BOOST_CHECK_EQUAL( track.restingTime(), 0 );
+}
+
+// Whichever order they come in, the GGA and RMC sentences for one time give one point, placed by the GGA.
+BOOST_AUTO_TEST_CASE( OnePointPerTime )
+{
+    const Track rmcFirst = trackFrom(rmc("120000", "5256.0001") + gga("120000", "5256.0000", "100.0"), 0);
+    const Track ggaFirst = trackFrom(gga("120000", "5256.0000", "100.0") + rmc("120000", "5256.0001"), 0);
+
+    for (const Track * track : { & rmcFirst, & ggaFirst })
+    {
+        BOOST_REQUIRE_EQUAL( track->numPositions(), 1 );
+        BOOST_CHECK_CLOSE( (*track)[0].latitude(), north1, 1e-12 );
+        BOOST_CHECK_EQUAL( (*track)[0].elevation(), 100 );
+    }
+}
+
+// A time with only an RMC sentence takes the elevation of the latest GGA.
+BOOST_AUTO_TEST_CASE( RMCOnly )
+{
+    const Track track = trackFrom(rmc("115950", "5255.0000") + gga("120000", "5256.0000", "100.0")
+                                + rmc("120010", "5257.0000") + rmc("120020", "5258.0000")
+                                + gga("120030", "5259.0000", "130.0"));
+
+    BOOST_REQUIRE_EQUAL( track.numPositions(), 5 );
+    BOOST_CHECK_EQUAL( track[0].elevation(), 0 );
+    BOOST_CHECK_EQUAL( track[2].elevation(), 100 );
+    BOOST_CHECK_CLOSE( track[2].latitude(), north2, 1e-12 );
+    BOOST_CHECK_EQUAL( track[3].elevation(), 100 );
+    BOOST_CHECK_CLOSE( track[3].latitude(), north3, 1e-12 );
+    BOOST_CHECK_EQUAL( track[4].elevation(), 130 );
+}
+
+// Times after midnight are on the next day; other times earlier than the last are skipped.
+BOOST_AUTO_TEST_CASE( Times )
+{
+    const Track track = trackFrom(gga("235950", "5256.0000", "10.0") + gga("235940", "5257.0000", "10.0")
+                                + gga("000010", "5258.0000", "10.0"));
+
+    BOOST_REQUIRE_EQUAL( track.numPositions(), 2 );
+    BOOST_CHECK_CLOSE( track[1].latitude(), north3, 1e-12 );
+    BOOST_CHECK_EQUAL( track.totalTime(), 20 );
+}
+
+// Corrupt sentences, sentences without a fix and other sentence types are skipped.
+BOOST_AUTO_TEST_CASE( SkippedSentences )
+{
+    const std::string log = GeneratedLogs::withChecksum("GPGGA,120000.00,5257.0000,N,00108.0000,W,1,08,0.9,90.0,M,46.9,M,,", true)
+                          + GeneratedLogs::withChecksum("GPGGA,120005.00,5257.0000,N,00108.0000,W,0,00,,,M,,M,,")
+                          + GeneratedLogs::withChecksum("GPRMC,120005.00,V,5257.0000,N,00108.0000,W,,,191194,,")
+                          + GeneratedLogs::withChecksum("GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1")
+                          + gga("120010", "5256.0000", "100.0");
+    const Track track = trackFrom(log);
+
+    BOOST_REQUIRE_EQUAL( track.numPositions(), 1 );
+    BOOST_CHECK_EQUAL( track[0].elevation(), 100 );
+
+    BOOST_CHECK_THROW( trackFrom(GeneratedLogs::withChecksum("GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1")), std::domain_error );
+    BOOST_CHECK_THROW( trackFrom(""), std::domain_error );
+}
+
+// A generated log of GGA and RMC pairs has one point for each second.
+BOOST_AUTO_TEST_CASE( GeneratedLog )
+{
+    const std::string log = GeneratedLogs::nmeaLog(20000);
+    unsigned int numSeconds = 0;
+    for (std::size_t pos = log.find("$GPRMC"); pos != std::string::npos; pos = log.find("$GPRMC", pos + 1)) ++numSeconds;
+
+    const Track track = trackFrom(log, 0);
+    BOOST_CHECK_EQUAL( track.numPositions(), numSeconds );
+    BOOST_CHECK_EQUAL( track.totalTime(), numSeconds - 1 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
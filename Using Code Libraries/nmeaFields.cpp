@@ -0,0 +1,55 @@
+#include <cstring>
+
+#include "nmeaFields.h"
+
+using namespace GPS;
+
+int GPS::hexDigitValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+bool GPS::isValidSentence(TextView sentence)
+{
+    // The shortest possible sentence is "$*hh".
+    if (sentence.size() < 4 || sentence.first[0] != '$' || sentence.last[-3] != '*') return false;
+
+    const int high = hexDigitValue(sentence.last[-2]);
+    const int low = hexDigitValue(sentence.last[-1]);
+    if (high < 0 || low < 0) return false;
+
+    unsigned char checksum = 0;
+    for (const char * pos = sentence.first + 1; pos != sentence.last - 3; ++pos)
+    {
+        checksum ^= (unsigned char)*pos;
+    }
+    return checksum == high * 16 + low;
+}
+
+bool GPS::decomposeSentence(TextView sentence, NMEAFields & result)
+{
+    if (sentence.empty() || sentence.first[0] != '$') return false;
+
+    const void * star = std::memchr(sentence.first, '*', sentence.size());
+    if (! star) return false;
+    const char * bodyEnd = static_cast<const char *>(star);
+
+    const char * fieldStart = sentence.first + 1;
+    const char * comma = static_cast<const char *>(std::memchr(fieldStart, ',', (std::size_t)(bodyEnd - fieldStart)));
+    if (! comma) comma = bodyEnd;
+    result.type = TextView(fieldStart, comma);
+    result.numFields = 0;
+
+    while (comma != bodyEnd)
+    {
+        if (result.numFields == NMEAFields::maxFields) return false;
+        fieldStart = comma + 1;
+        comma = static_cast<const char *>(std::memchr(fieldStart, ',', (std::size_t)(bodyEnd - fieldStart)));
+        if (! comma) comma = bodyEnd;
+        result.fields[result.numFields++] = TextView(fieldStart, comma);
+    }
+    return true;
+}
@@ -0,0 +1,36 @@
+#ifndef NMEAFIELDS_H_211217
+#define NMEAFIELDS_H_211217
+
+#include <cstddef>
+
+#include "textview.h"
+
+namespace GPS
+{
+  // The type and fields of an NMEA sentence, as views of the caller's buffer.
+  struct NMEAFields
+  {
+      static const std::size_t maxFields = 64;
+
+      TextView type;                 // E.g. "GPGGA".
+      TextView fields[maxFields];    // The comma-separated fields after the type; some may be empty.
+      std::size_t numFields;
+  };
+
+  /*  As isValidSentence(const std::string &), but without copying the sentence:
+   *  the checksum is accumulated in a single pass over the caller's buffer.
+   *  Also requires the sentence to start with '$' and to have a '*' before the checksum.
+   */
+  bool isValidSentence(TextView sentence);
+
+  // The value of a hexadecimal digit of either case, or -1 if "c" is not one.
+  int hexDigitValue(char c);
+
+  /*  Splits a sentence of the form "$TYPE,field,...,field*hh" into "result" without allocating;
+   *  the views remain valid only while the caller's buffer does.  The checksum is not checked.
+   *  Returns false if the sentence is not of that form or has more than NMEAFields::maxFields fields.
+   */
+  bool decomposeSentence(TextView sentence, NMEAFields & result);
+}
+
+#endif
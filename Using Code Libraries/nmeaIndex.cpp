@@ -0,0 +1,248 @@
+#include <limits>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define NMEA_VECTOR_SCAN
+#include <immintrin.h>
+#endif
+
+#include "nmeaIndex.h"
+
+using namespace GPS;
+
+namespace
+{
+    unsigned int lowestBit(std::uint32_t mask)
+    {
+#if defined(__GNUC__)
+        return (unsigned int)__builtin_ctz(mask);
+#else
+        unsigned int bit = 0;
+        while (! (mask & 1)) { mask >>= 1; ++bit; }
+        return bit;
+#endif
+    }
+
+    // The bits below "bit" (which may be 32).
+    std::uint32_t bitsBelow(std::size_t bit)
+    {
+        return (bit >= 32) ? ~std::uint32_t(0) : (std::uint32_t(1) << bit) - 1;
+    }
+
+    // The XOR of the characters in [first, last).
+    unsigned char xorRange(const char * first, const char * last)
+    {
+        unsigned char checksum = 0;
+#ifdef NMEA_VECTOR_SCAN
+        if (last - first >= 16)
+        {
+            __m128i acc = _mm_setzero_si128();
+            for (; last - first >= 16; first += 16)
+            {
+                acc = _mm_xor_si128(acc, _mm_loadu_si128(reinterpret_cast<const __m128i *>(first)));
+            }
+            acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 8));
+            acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 4));
+            acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 2));
+            acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 1));
+            checksum = (unsigned char)_mm_cvtsi128_si32(acc);
+        }
+#endif
+        for (; first != last; ++first) checksum ^= (unsigned char)*first;
+        return checksum;
+    }
+
+    const std::size_t blockSize = 32;
+
+    /*  For each of the 32 characters at "block", sets the corresponding bit of "structure" if it is
+     *  a '$', '*' or newline, and of "commas" if it is a ','.
+     */
+    void scanBlock(const char * block, std::uint32_t & structure, std::uint32_t & commas)
+    {
+#if defined(__AVX2__)
+        const __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+        const __m256i found = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('$')), _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('*'))),
+            _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\n')));
+        structure = (std::uint32_t)_mm256_movemask_epi8(found);
+        commas = (std::uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8(',')));
+#elif defined(NMEA_VECTOR_SCAN)
+        structure = commas = 0;
+        for (unsigned int half = 0; half < 2; ++half)
+        {
+            const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 16 * half));
+            const __m128i found = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('$')), _mm_cmpeq_epi8(chars, _mm_set1_epi8('*'))),
+                _mm_cmpeq_epi8(chars, _mm_set1_epi8('\n')));
+            structure |= (std::uint32_t)_mm_movemask_epi8(found) << (16 * half);
+            commas |= (std::uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chars, _mm_set1_epi8(','))) << (16 * half);
+        }
+#else
+        structure = commas = 0;
+        for (unsigned int i = 0; i < blockSize; ++i)
+        {
+            const char c = block[i];
+            if (c == '$' || c == '*' || c == '\n') structure |= std::uint32_t(1) << i;
+            else if (c == ',') commas |= std::uint32_t(1) << i;
+        }
+#endif
+    }
+}
+
+/*  The log is scanned 32 characters at a time.  Each block yields a bitmask of its '$', '*' and
+ *  newline characters, which are visited one by one, and a bitmask of its commas, whose positions
+ *  are copied into "fieldStarts" in a tight loop while inside a sentence.  The last partial block
+ *  is copied into a zero-filled buffer so that every block is scanned the same way.
+ */
+void NMEAIndex::build(TextView source)
+{
+    log = source.first;
+    entries.clear();
+    fieldStarts.clear();
+
+    const char * const first = source.first;
+    const std::size_t size = source.last - source.first;
+    const std::size_t maxLength = std::numeric_limits<Offset>::max() - 2 * blockSize;
+
+    bool inSentence = false; // Between a '$' and its '*'.
+    std::size_t skipTo = 0;  // The end of the last checksum; its digits are not delimiters.
+    Entry entry = Entry();
+
+    // Ends an incomplete sentence at offset "end".
+    auto abandon = [&](std::size_t end)
+    {
+        entry.bodyEnd = entry.length = (Offset)(end - entry.start);
+        entry.valid = false;
+        entries.push_back(entry);
+        inSentence = false;
+    };
+
+    auto addFields = [&](std::size_t base, std::uint32_t commas)
+    {
+        const std::size_t offset = base - entry.start + 1;
+        for (; commas != 0; commas &= commas - 1)
+        {
+            fieldStarts.push_back((Offset)(offset + lowestBit(commas)));
+            ++entry.numFields;
+        }
+    };
+
+    char tail[blockSize];
+    for (std::size_t base = 0; base < size; base += blockSize)
+    {
+        std::uint32_t structure, commas;
+        if (size - base >= blockSize)
+        {
+            scanBlock(first + base, structure, commas);
+        }
+        else
+        {
+            std::memset(tail, 0, blockSize);
+            std::memcpy(tail, first + base, size - base);
+            scanBlock(tail, structure, commas);
+        }
+
+        if (skipTo > base)
+        {
+            structure &= ~bitsBelow(skipTo - base);
+            commas &= ~bitsBelow(skipTo - base);
+        }
+        if (inSentence && base - entry.start > maxLength)
+        {
+            fieldStarts.resize(entry.firstField);
+            inSentence = false; // Too long to index; not an NMEA sentence.
+        }
+
+        for (; structure != 0; structure &= structure - 1)
+        {
+            const unsigned int bit = lowestBit(structure);
+            const std::size_t pos = base + bit;
+            if (pos < skipTo) continue;
+
+            if (inSentence) addFields(base, commas & bitsBelow(bit));
+            commas &= ~bitsBelow(bit);
+
+            switch (first[pos])
+            {
+              case '$':
+                if (inSentence) abandon(pos);
+                entry.start = pos;
+                entry.firstField = fieldStarts.size();
+                entry.numFields = 1;
+                fieldStarts.push_back(1);
+                inSentence = true;
+                break;
+
+              case '\n':
+                if (inSentence) abandon(pos);
+                break;
+
+              case '*':
+                if (! inSentence) break;
+                {
+                    // The checksum is the next two characters, unless a newline or '$' comes first.
+                    std::size_t end = pos + 1;
+                    while (end < std::min(pos + 3, size) && first[end] != '\n' && first[end] != '$') ++end;
+                    entry.bodyEnd = (Offset)(pos - entry.start);
+                    entry.length = (Offset)(end - entry.start);
+                    entry.valid = false;
+                    if (end == pos + 3)
+                    {
+                        const int high = hexDigitValue(first[pos + 1]);
+                        const int low = hexDigitValue(first[pos + 2]);
+                        entry.valid = high >= 0 && low >= 0
+                                   && xorRange(first + entry.start + 1, first + pos) == high * 16 + low;
+                    }
+                    entries.push_back(entry);
+                    inSentence = false;
+                    skipTo = end;
+                }
+                break;
+            }
+        }
+        if (inSentence) addFields(base, commas);
+    }
+
+    if (inSentence) abandon(size);
+}
+
+TextView NMEAIndex::sentence(std::size_t i) const
+{
+    const char * start = log + entries[i].start;
+    return TextView(start, start + entries[i].length);
+}
+
+TextView NMEAIndex::fieldView(const Entry & entry, std::size_t index) const
+{
+    const char * start = log + entry.start;
+    const std::size_t fieldStart = fieldStarts[entry.firstField + index];
+    const std::size_t fieldEnd = (index + 1 < entry.numFields)
+                               ? fieldStarts[entry.firstField + index + 1] - 1
+                               : entry.bodyEnd;
+    return TextView(start + fieldStart, start + fieldEnd);
+}
+
+TextView NMEAIndex::type(std::size_t i) const
+{
+    return fieldView(entries[i], 0);
+}
+
+TextView NMEAIndex::field(std::size_t i, std::size_t fieldNum) const
+{
+    return fieldView(entries[i], fieldNum + 1);
+}
+
+bool NMEAIndex::decompose(std::size_t i, NMEAFields & fields) const
+{
+    const Entry & entry = entries[i];
+    if (entry.numFields > NMEAFields::maxFields + 1) return false;
+
+    fields.type = fieldView(entry, 0);
+    fields.numFields = entry.numFields - 1;
+    for (std::size_t f = 0; f < fields.numFields; ++f)
+    {
+        fields.fields[f] = fieldView(entry, f + 1);
+    }
+    return true;
+}
@@ -0,0 +1,72 @@
+#ifndef NMEAINDEX_H_211217
+#define NMEAINDEX_H_211217
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "nmeaFields.h"
+
+namespace GPS
+{
+  /*  The location of every sentence, and of every field within it, in a buffer holding an NMEA log.
+   *
+   *  build() scans the whole buffer for '$', '*', ',' and newline characters with SSE2 or AVX2 compares
+   *  (one byte at a time on other processors), and checks each sentence's checksum with a vector XOR
+   *  reduction.  A sentence runs from a '$' to the two checksum digits after the next '*'.  A '$' or
+   *  newline before the '*' or within the checksum ends the sentence early; it is still indexed, but is
+   *  not valid.  As no sentence spans a newline, indexing a log in pieces split after newlines gives the
+   *  same sentences as indexing it whole.  Offsets within a sentence are stored in 16 bits, so a
+   *  "sentence" of more than 65000 characters (NMEA allows 82) is not indexed at all.
+   *
+   *  A valid sentence is one that isValidSentence() would accept, and its type and fields are those
+   *  that decomposeSentence() would return.  The index refers to the buffer, which must outlive it.
+   */
+  class NMEAIndex
+  {
+    public:
+      // Indexes the sentences in "log", replacing any previous contents.
+      void build(TextView log);
+
+      std::size_t numSentences() const { return entries.size(); }
+
+      // Is sentence "i" complete, with a correct checksum?
+      bool isValid(std::size_t i) const { return entries[i].valid; }
+
+      // The offset of the '$' that starts sentence "i" within the log.
+      std::size_t offset(std::size_t i) const { return entries[i].start; }
+
+      // The whole of sentence "i", from the '$' up to the end of the checksum (if any).
+      TextView sentence(std::size_t i) const;
+
+      // The type of sentence "i" (e.g. "GPGGA"), and its fields, numbered from 0 as in NMEAFields.
+      TextView type(std::size_t i) const;
+      std::size_t numFields(std::size_t i) const { return entries[i].numFields - 1; }
+      TextView field(std::size_t i, std::size_t fieldNum) const;
+
+      // Copies the views of the type and fields of sentence "i" into "fields"; false if there are too many.
+      bool decompose(std::size_t i, NMEAFields & fields) const;
+
+    private:
+      // An offset within a sentence.
+      typedef std::uint16_t Offset;
+
+      struct Entry
+      {
+          std::size_t start;      // The offset of the '$'.
+          std::size_t firstField; // Into "fieldStarts"; the type comes first.
+          Offset bodyEnd;         // The offset of the '*' (or the end of an incomplete sentence) from "start".
+          Offset length;          // Including the '*' and checksum.
+          Offset numFields;       // Including the type.
+          bool valid;
+      };
+
+      const char * log = nullptr;
+      std::vector<Entry> entries;
+      std::vector<Offset> fieldStarts; // Offsets from the start of each sentence.
+
+      TextView fieldView(const Entry &, std::size_t index) const;
+  };
+}
+
+#endif
@@ -0,0 +1,87 @@
+/*  Throughput of NMEAIndex compared with validating and decomposing a log one sentence at a time.
+ *
+ *  Builds a 100MB log of GGA and RMC sentences in memory, one in a hundred with a corrupted checksum,
+ *  then times splitting it into lines and calling isValidSentence() and decomposeSentence() on each,
+ *  against NMEAIndex::build().  The index is built twice: the first build includes allocating the
+ *  tables, which a reused index (as when processing a series of files) avoids.  Build with -mavx2 for
+ *  AVX2 compares; x86-64 defaults to SSE2.
+ */
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+#include "nmeaIndex.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+namespace
+{
+    template <typename Function>
+    double timeInMilliseconds(Function f)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto finish = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(finish - start).count();
+    }
+}
+
+int main()
+{
+    const std::string log = GeneratedLogs::nmeaLog(100 * 1024 * 1024);
+    const TextView whole(log.data(), log.data() + log.size());
+
+    std::size_t lineValid = 0, lineFields = 0;
+    double lineTime = timeInMilliseconds([&]()
+    {
+        NMEAFields fields;
+        const char * pos = whole.first;
+        while (pos != whole.last)
+        {
+            const char * end = pos;
+            while (end != whole.last && *end != '\r' && *end != '\n') ++end;
+            const TextView line(pos, end);
+            if (isValidSentence(line) && decomposeSentence(line, fields))
+            {
+                ++lineValid;
+                lineFields += fields.numFields;
+            }
+            while (end != whole.last && (*end == '\r' || *end == '\n')) ++end;
+            pos = end;
+        }
+    });
+
+    NMEAIndex index;
+    std::size_t indexValid = 0, indexFields = 0;
+    auto buildIndex = [&]()
+    {
+        indexValid = indexFields = 0;
+        index.build(whole);
+        for (std::size_t i = 0; i < index.numSentences(); ++i)
+        {
+            if (index.isValid(i))
+            {
+                ++indexValid;
+                indexFields += index.numFields(i);
+            }
+        }
+    };
+    double firstIndexTime = timeInMilliseconds(buildIndex);
+    double reusedIndexTime = timeInMilliseconds(buildIndex);
+
+    const double megabytes = log.size() / (1024.0 * 1024.0);
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << megabytes << "MB, " << index.numSentences() << " sentences" << std::endl;
+    std::cout << std::setw(20) << "" << std::setw(12) << "ms" << std::setw(12) << "MB/s"
+              << std::setw(12) << "valid" << std::setw(12) << "fields" << std::endl;
+    std::cout << std::setw(20) << "per sentence" << std::setw(12) << lineTime << std::setw(12) << megabytes * 1000 / lineTime
+              << std::setw(12) << lineValid << std::setw(12) << lineFields << std::endl;
+    std::cout << std::setw(20) << "NMEAIndex (first)" << std::setw(12) << firstIndexTime
+              << std::setw(12) << megabytes * 1000 / firstIndexTime << std::endl;
+    std::cout << std::setw(20) << "NMEAIndex (reused)" << std::setw(12) << reusedIndexTime
+              << std::setw(12) << megabytes * 1000 / reusedIndexTime
+              << std::setw(12) << indexValid << std::setw(12) << indexFields << std::endl;
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include <thread>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+
+#include "parallelfor.h"
+#include "nmeaIndex.h"
+#include "nmeaLog.h"
+
+using namespace GPS;
+
+namespace
+{
+    const std::size_t minChunkSize = 1 << 20;
+    const unsigned int chunksPerThread = 8;
+
+    unsigned int threadCount(unsigned int requested)
+    {
+        unsigned int numThreads = requested ? requested : std::thread::hardware_concurrency();
+        return numThreads ? numThreads : 1;
+    }
+
+    // Splits the log into chunks of about "chunkSize" characters, each ending just after a newline (or at the end).
+    std::vector<TextView> splitAfterNewlines(TextView log, std::size_t chunkSize)
+    {
+        std::vector<TextView> chunks;
+        const char * start = log.first;
+        while (start != log.last)
+        {
+            const char * end = log.last;
+            if ((std::size_t)(log.last - start) > chunkSize)
+            {
+                const void * newline = std::memchr(start + chunkSize, '\n', log.last - (start + chunkSize));
+                if (newline) end = static_cast<const char *>(newline) + 1;
+            }
+            chunks.push_back(TextView(start, end));
+            start = end;
+        }
+        return chunks;
+    }
+
+    // Why an invalid sentence, as indexed by NMEAIndex, was rejected.
+    NMEAFault faultIn(TextView sentence)
+    {
+        const char * star = static_cast<const char *>(std::memchr(sentence.first, '*', sentence.size()));
+        if (! star) return NMEAFault::NoChecksum;
+        if (sentence.last - star != 3 || ! std::isxdigit((unsigned char)star[1]) || ! std::isxdigit((unsigned char)star[2]))
+        {
+            return NMEAFault::NonHexChecksum;
+        }
+        return NMEAFault::WrongChecksum;
+    }
+
+    // How many of each result a chunk's index holds, and so where the next chunk's results go.
+    struct Placement
+    {
+        std::size_t sentences;
+        std::size_t fields;
+        std::size_t failures;
+    };
+
+    Placement countResults(const NMEAIndex & index)
+    {
+        Placement counts = { 0, 0, 0 };
+        for (std::size_t i = 0; i < index.numSentences(); ++i)
+        {
+            if (index.isValid(i))
+            {
+                ++counts.sentences;
+                counts.fields += index.numFields(i);
+            }
+            else ++counts.failures;
+        }
+        return counts;
+    }
+
+    // Copies the results from a chunk's index into place, with offsets made relative to the start of the log.
+    void placeResults(const NMEAIndex & index, std::size_t chunkOffset, Placement place, NMEALogContents & contents)
+    {
+        for (std::size_t i = 0; i < index.numSentences(); ++i)
+        {
+            const std::size_t offset = chunkOffset + index.offset(i);
+            if (! index.isValid(i))
+            {
+                contents.failures[place.failures++] = NMEAFailure{ offset, faultIn(index.sentence(i)) };
+                continue;
+            }
+            const NMEASentence sentence = { offset, index.type(i), place.fields, index.numFields(i) };
+            for (std::size_t f = 0; f < sentence.numFields; ++f)
+            {
+                contents.fields[place.fields++] = index.field(i, f);
+            }
+            contents.sentences[place.sentences++] = sentence;
+        }
+    }
+}
+
+const char * GPS::describe(NMEAFault fault)
+{
+    switch (fault)
+    {
+      case NMEAFault::NoChecksum:     return "No '*' before the end of the sentence.";
+      case NMEAFault::NonHexChecksum: return "Checksum is not two hexadecimal digits.";
+      case NMEAFault::WrongChecksum:  return "Checksum does not match.";
+    }
+    return "Unknown fault.";
+}
+
+NMEALogContents GPS::processNMEALog(TextView log, unsigned int numThreads)
+{
+    numThreads = threadCount(numThreads);
+    const std::size_t chunkSize = std::max(minChunkSize, log.size() / (numThreads * chunksPerThread) + 1);
+    const std::vector<TextView> chunks = splitAfterNewlines(log, chunkSize);
+
+    // Each chunk is indexed, and its results counted.
+    std::vector<NMEAIndex> indexes(chunks.size());
+    std::vector<Placement> placements(chunks.size() + 1);
+    parallelFor(chunks.size(), numThreads, [&](std::size_t c)
+    {
+        indexes[c].build(chunks[c]);
+        placements[c + 1] = countResults(indexes[c]);
+    });
+
+    // Turn the counts into the position of each chunk's first result.
+    placements[0] = Placement{ 0, 0, 0 };
+    for (std::size_t c = 0; c < chunks.size(); ++c)
+    {
+        placements[c + 1].sentences += placements[c].sentences;
+        placements[c + 1].fields += placements[c].fields;
+        placements[c + 1].failures += placements[c].failures;
+    }
+
+    NMEALogContents contents;
+    contents.sentences.resize(placements.back().sentences);
+    contents.fields.resize(placements.back().fields);
+    contents.failures.resize(placements.back().failures);
+
+    // Then the results of each chunk are written straight into place.
+    parallelFor(chunks.size(), numThreads, [&](std::size_t c)
+    {
+        placeResults(indexes[c], chunks[c].first - log.first, placements[c], contents);
+        indexes[c] = NMEAIndex();
+    });
+
+    return contents;
+}
@@ -0,0 +1,62 @@
+#ifndef NMEALOG_H_211217
+#define NMEALOG_H_211217
+
+#include <vector>
+#include <cstddef>
+
+#include "nmeaFields.h"
+
+namespace GPS
+{
+  // Why a sentence in an NMEA log was rejected.
+  enum class NMEAFault
+  {
+    NoChecksum,     // No '*' before the end of the line.
+    NonHexChecksum, // The '*' is not followed by two hexadecimal digits.
+    WrongChecksum   // The checksum does not match the sentence.
+  };
+
+  // A short description of the fault, e.g. "Checksum does not match."
+  const char * describe(NMEAFault);
+
+  struct NMEAFailure
+  {
+      std::size_t offset; // Of the '$' that starts the sentence.
+      NMEAFault fault;
+  };
+
+  struct NMEASentence
+  {
+      std::size_t offset;     // Of the '$' that starts the sentence.
+      TextView type;          // E.g. "GPGGA".
+      std::size_t firstField; // Into NMEALogContents::fields.
+      std::size_t numFields;
+  };
+
+  /*  The valid sentences of an NMEA log and the failures found in it, both in log order.
+   *  All the views are of the log buffer, which must outlive them.
+   */
+  struct NMEALogContents
+  {
+      std::vector<NMEASentence> sentences;
+      std::vector<TextView> fields; // The fields of every sentence, one after another.
+      std::vector<NMEAFailure> failures;
+
+      TextView field(const NMEASentence & sentence, std::size_t fieldNum) const
+      {
+          return fields[sentence.firstField + fieldNum];
+      }
+  };
+
+  /*  Validates and decomposes every sentence in a whole NMEA log, reporting invalid sentences as
+   *  failures rather than throwing.  Sentences are found as by NMEAIndex, and text outside them is
+   *  ignored.
+   *
+   *  The log is split after newlines into chunks, which "numThreads" threads (0 for one per core)
+   *  claim one at a time, indexing each and counting its results.  Once the counts give where each
+   *  chunk's results go, the threads write them straight into place, so the merge is not serial.
+   */
+  NMEALogContents processNMEALog(TextView log, unsigned int numThreads = 0);
+}
+
+#endif
@@ -0,0 +1,46 @@
+/*  Scaling of processNMEALog() with the number of threads.
+ *
+ *  Builds a 200MB log of GGA and RMC sentences in memory, one in a hundred with a corrupted checksum,
+ *  and times processing it with 1, 2, 4, 8 and 16 threads.  Each run should report the same counts.
+ */
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+#include "nmeaLog.h"
+#include "generatedLogs.h"
+
+using namespace GPS;
+
+namespace
+{
+    template <typename Function>
+    double timeInMilliseconds(Function f)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto finish = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(finish - start).count();
+    }
+}
+
+int main()
+{
+    const std::string log = GeneratedLogs::nmeaLog(200 * 1024 * 1024);
+    const TextView whole(log.data(), log.data() + log.size());
+    const double megabytes = log.size() / (1024.0 * 1024.0);
+
+    std::cout << std::fixed << std::setprecision(1) << megabytes << "MB" << std::endl;
+    std::cout << std::setw(10) << "threads" << std::setw(12) << "ms" << std::setw(12) << "MB/s"
+              << std::setw(12) << "sentences" << std::setw(12) << "failures" << std::endl;
+
+    for (unsigned int numThreads : { 1, 2, 4, 8, 16 })
+    {
+        NMEALogContents contents;
+        double time = timeInMilliseconds([&]() { contents = processNMEALog(whole, numThreads); });
+        std::cout << std::setw(10) << numThreads << std::setw(12) << time << std::setw(12) << megabytes * 1000 / time
+                  << std::setw(12) << contents.sentences.size() << std::setw(12) << contents.failures.size() << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include <fstream>
+#include <stdexcept>
+#include <cmath>
+#include <cctype>
+
+#include "nmeaTrack.h"
+
+using namespace GPS;
+
+namespace
+{
+    const seconds secondsPerDay = 24 * 60 * 60;
+
+    // Does the sentence type (e.g. "GPGGA") end with "format" (e.g. "GGA")?
+    bool isFormat(const std::string & type, const char * format)
+    {
+        return type.size() >= 3 && type.compare(type.size() - 3, 3, format) == 0;
+    }
+
+    // Converts an NMEA "(d)ddmm.mmmm" value and its hemisphere to signed degrees.
+    degrees toDegrees(const std::string & value, const std::string & hemisphere)
+    {
+        double ddmm = std::stod(value);
+        double wholeDegrees = std::floor(ddmm / 100);
+        degrees result = wholeDegrees + (ddmm - wholeDegrees * 100) / 60;
+        if (hemisphere == "S" || hemisphere == "W") return -result;
+        if (hemisphere == "N" || hemisphere == "E") return result;
+        throw std::invalid_argument("Invalid hemisphere.");
+    }
+
+    // Converts an NMEA "hhmmss(.ss)" time to whole seconds since midnight.
+    seconds toTimeOfDay(const std::string & value)
+    {
+        if (value.size() < 6) throw std::invalid_argument("Invalid time.");
+        return std::stoul(value.substr(0, 2)) * 3600 + std::stoul(value.substr(2, 2)) * 60
+             + std::stoul(value.substr(4, 2));
+    }
+
+    // A fix read from a GGA or RMC sentence.
+    struct Fix
+    {
+        seconds timeOfDay;
+        degrees latitude;
+        degrees longitude;
+        bool hasElevation;
+        metres elevation;
+    };
+
+    // Reads the fix from a GGA or RMC sentence; returns false for other sentences and those without a fix.
+    bool extractFix(const NMEAPair & sentence, Fix & fix)
+    {
+        const std::vector<std::string> & fields = sentence.second;
+
+        if (isFormat(sentence.first, "GGA"))
+        {
+            // time, lat, N/S, lon, E/W, quality, satellites, HDOP, altitude, ...
+            if (fields.size() < 9 || fields[5].empty() || fields[5] == "0") return false;
+            fix.timeOfDay = toTimeOfDay(fields[0]);
+            fix.latitude = toDegrees(fields[1], fields[2]);
+            fix.longitude = toDegrees(fields[3], fields[4]);
+            fix.hasElevation = ! fields[8].empty();
+            if (fix.hasElevation) fix.elevation = std::stod(fields[8]);
+            return true;
+        }
+        if (isFormat(sentence.first, "RMC"))
+        {
+            // time, status, lat, N/S, lon, E/W, ...
+            if (fields.size() < 6 || fields[1] != "A") return false;
+            fix.timeOfDay = toTimeOfDay(fields[0]);
+            fix.latitude = toDegrees(fields[2], fields[3]);
+            fix.longitude = toDegrees(fields[4], fields[5]);
+            fix.hasElevation = false;
+            return true;
+        }
+        return false;
+    }
+}
+
+Track GPS::trackFromNMEA(std::istream & log, metres granularity)
+{
+    Track track(granularity);
+    std::string line;
+    metres elevation = 0;
+    seconds dayStart = 0;
+
+    // The fix for the latest time, held back until every sentence for that time has been read.
+    Fix pending{};
+    seconds pendingTime = 0;
+    bool hasPending = false;
+
+    auto appendPending = [&]()
+    {
+        if (pending.hasElevation) elevation = pending.elevation;
+        track.append(Position(pending.latitude, pending.longitude, elevation), pendingTime);
+    };
+
+    while (std::getline(log, line))
+    {
+        // Logs captured from serial ports usually have CRLF line endings.
+        while (! line.empty() && std::isspace((unsigned char)line.back())) line.pop_back();
+        if (line.size() < 4 || line[0] != '$' || line[line.size() - 3] != '*') continue;
+
+        Fix fix{};
+        try
+        {
+            if (! isValidSentence(line) || ! extractFix(decomposeSentence(line), fix)) continue;
+        }
+        catch (const std::exception &) // A malformed field.
+        {
+            continue;
+        }
+
+        seconds time = dayStart + fix.timeOfDay;
+        if (hasPending && time + secondsPerDay / 2 < pendingTime)
+        {
+            dayStart += secondsPerDay;
+            time += secondsPerDay;
+        }
+        if (hasPending && time < pendingTime) continue;
+
+        if (hasPending && time == pendingTime)
+        {
+            // Another sentence for the same fix, typically the GGA to go with an RMC; keep the one with an elevation.
+            if (fix.hasElevation && ! pending.hasElevation) pending = fix;
+            continue;
+        }
+
+        if (hasPending) appendPending();
+        pending = fix;
+        pendingTime = time;
+        hasPending = true;
+    }
+
+    if (! hasPending)
+    {
+        throw std::domain_error("No GGA or RMC fixes in NMEA log.");
+    }
+    appendPending();
+    return track;
+}
+
+Track GPS::trackFromNMEALog(const std::string & filepath, metres granularity)
+{
+    std::ifstream log(filepath);
+    if (! log.good())
+    {
+        throw std::invalid_argument("Error opening source file '" + filepath + "'.");
+    }
+    return trackFromNMEA(log, granularity);
+}
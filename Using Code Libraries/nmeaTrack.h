@@ -0,0 +1,33 @@
+#ifndef NMEATRACK_H_211217
+#define NMEATRACK_H_211217
+
+#include <string>
+#include <istream>
+
+#include "types.h"
+#include "parseNMEA.h"
+#include "track.h"
+
+namespace GPS
+{
+  /*  Builds a Track directly from an NMEA log, without going through GPX.
+   *
+   *  Each line that passes isValidSentence() is split by decomposeSentence(), and every GGA or RMC
+   *  sentence (from any talker, e.g. "GPGGA" or "GNRMC") that reports a fix is used, in order.
+   *  Sentences with the same time describe the same fix, so only one point is appended for each
+   *  time: that of the first sentence with an elevation if there is one, otherwise that of the first
+   *  sentence.  RMC sentences carry no elevation, so a time without one takes the most recent elevation.
+   *
+   *  Track times count from midnight on the day of the first fix: NMEA times are times of day, so a
+   *  time more than 12 hours earlier than the previous one is taken to be on the next day.  Any other
+   *  fix earlier than its predecessor is skipped, as are invalid sentences and sentences of other types.
+   *
+   *  Throws a std::domain_error exception if the log contains no usable fixes.
+   */
+  Track trackFromNMEA(std::istream & log, metres granularity = 10);
+
+  // As above, reading the log from a file.  Throws a std::invalid_argument exception if the file cannot be opened.
+  Track trackFromNMEALog(const std::string & filepath, metres granularity = 10);
+}
+
+#endif
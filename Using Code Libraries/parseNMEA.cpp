@@ -1,4 +1,5 @@
 #include "parseNMEA.h"
+#include "nmeaFields.h"
 #include <iostream>
 #include <string>
 
@@ -9,89 +10,56 @@ namespace GPS {
 
 bool isValidSentence(const std::string & theLog)
 {
-    string Sentence = theLog;
-    int checksum = 0;
-    
-    /* Create a vector to stor the characters of the
-     * string. */
-    vector<char> check (Sentence.begin(), Sentence.end());
-    
-    // Discard the sentence exept the checksum
-    Sentence.erase(Sentence.begin(), Sentence.end() - 2);
-    
     /* Check if the checksum is hexadecimal. Then convert
-     * the checksum to an integer.
-     * Then we XOR the characters of the vector tho find 
-     * the checksum.
-     * And  compareit to the hex. */
-    if (!isxdigit(Sentence.at(0)))
+     * the checksum to an integer; if only the first digit
+     * is hexadecimal, that digit alone is the checksum.
+     * Then XOR the characters between the "$" and the "*"
+     * in a single pass over the sentence, without copying it,
+     * and compare it to the hex. */
+    int high = hexDigitValue(theLog.at(theLog.size() - 2));
+    if (high < 0)
     {
         return false;
     }
-    else
+
+    int low = hexDigitValue(theLog.back());
+    int hex = (low < 0) ? high : high * 16 + low;
+    int checksum = 0;
+
+    for (size_t i = 1; i + 3 < theLog.size(); i++)
     {
-        int hex = stol(Sentence,0,16);
-        
-        for (int i=1; i < check.size() - 3 ; i++)
-        {
-            checksum ^= check.at(i);
-        }
-        
-        if (checksum != hex)
-        {
-            return false;
-        }
-        return true;
+        checksum ^= theLog[i];
     }
 
+    return checksum == hex;
 }
 
 
 
 NMEAPair decomposeSentence(const std::string & nmeaSentence)
 {
-    string sameSentence = nmeaSentence;
-    vector<string> secondElement;
-    size_t size;
-    string token;
-    
     // Remove "$" and  checksum (e.g. "*63")
-    sameSentence.erase (sameSentence.begin());
+    string sameSentence = nmeaSentence.substr(1);
     sameSentence.erase (sameSentence.find_first_of("*"),3);
-    
-    /* Extract the value up until the first "," and put
-     * it into a vector, discard the value and repeat 
-     * until the end of the string. */
 
+    /* Split the sentence at each "," in a single pass.
+     * The value before the first "," is the first element
+     * of the pair, and the other values are the second. */
+    NMEAPair result;
+    size_t start = 0;
+    size_t comma = sameSentence.find(',');
 
-    while ((size = sameSentence.find_first_of(",")) != string::npos)
+    result.first = sameSentence.substr(0, comma);
+    while (comma != string::npos)
     {
-        token = sameSentence.substr(0,size);
-        secondElement.push_back(token);
-        sameSentence.erase (0,size + 1);
-        
+        start = comma + 1;
+        comma = sameSentence.find(',', start);
+        result.second.push_back(sameSentence.substr(start, comma == string::npos ? string::npos : comma - start));
     }
-    // last element of the vector
-    secondElement.push_back(sameSentence);
-    /* Set the first value of the vector as the first
-     * element of the pair and put the other values as
-     * the second element of the pair. */
 
-    NMEAPair firstElement;
-    {
-        firstElement.first = secondElement[0];
-        
-        for (unsigned int i = 1; i <secondElement.size(); i++)
-        {
-            firstElement.second.push_back(secondElement[i]);
-        }
-    }
-    
-    return{firstElement.first,firstElement.second};
-    
-    
+    return result;
 }
-    
+
 }
 
 